@@ -108,6 +108,106 @@ struct SlogDerivedLogger {
 	    : logger{slog::BuildSink(std::forward<Options>(options)...)} {}
 };
 
+// Writes to an unlocked FileSink through its static type, formatting the
+// records in JSON without any virtual call.
+struct SlogTypedLogger {
+	using SinkT = slog::FileSink<slog::STSafe>;
+
+	slog::Logger<0, SinkT, slog::JSONFormatter> logger;
+
+	void operator()(const BenchmarkData &data) {
+		using namespace slog;
+		using slog::Duration;
+
+		logger.Info(
+		    "new data",
+		    Int("code", data.code),
+		    Float("value", data.value),
+		    Duration("duration", data.duration),
+		    Time("time", data.time),
+		    Group(
+		        "request",
+		        String("url", data.request.url),
+		        Int("status", data.request.status)
+		    )
+		);
+	}
+
+	template <typename... Options>
+	SlogTypedLogger(Options &&...options)
+	    : logger{slog::BuildTypedSink<SinkT>(std::forward<Options>(options)...)
+	      } {}
+};
+
+// As SlogTypedLogger, with literal keys, so that the attributes are encoded
+// through a plan computed at compile time. Groups cannot be planned, so the
+// request is flattened.
+struct SlogPlannedLogger {
+	using SinkT = slog::FileSink<slog::STSafe>;
+
+	slog::Logger<0, SinkT, slog::JSONFormatter> logger;
+
+	void operator()(const BenchmarkData &data) {
+		using namespace slog;
+		using slog::Duration;
+
+		logger.Info(
+		    "new data",
+		    Int<"code">(data.code),
+		    Float<"value">(data.value),
+		    Duration<"duration">(data.duration),
+		    Time<"time">(data.time),
+		    StringView<"request.url">(data.request.url),
+		    Int<"request.status">(data.request.status)
+		);
+	}
+
+	template <typename... Options>
+	SlogPlannedLogger(Options &&...options)
+	    : logger{slog::BuildTypedSink<SinkT>(std::forward<Options>(options)...)
+	      } {}
+};
+
+// A sink discarding the records it is given, built on the stack.
+struct NullSink : public slog::Sink {
+	bool AllocateOnStack() const noexcept override {
+		return true;
+	}
+
+	bool Enabled(slog::Level) const noexcept override {
+		return true;
+	}
+
+	void From(slog::Level) noexcept override {}
+
+	void Set(slog::Level, bool) noexcept override {}
+
+	void Log(RecordVariant &&) override {}
+
+	void Flush(std::shared_ptr<slog::FlushBarrier>) override {}
+};
+
+// Only copies attributes, in Logger<N>::With() and in the Record<N> built by
+// Info(), so that it measures the footprint of Attribute. Compare builds with
+// and without SLOGPP_COMPACT_VALUE_OBJECT.
+struct SlogCopies {
+
+	slog::Logger<0> logger{std::make_shared<NullSink>()};
+
+	void operator()(const BenchmarkData &data) {
+		using namespace slog;
+		using slog::Duration;
+		auto derived = logger.With(
+		    Int("code", data.code),
+		    Float("value", data.value),
+		    Duration("duration", data.duration),
+		    Time("time", data.time),
+		    String("url", data.request.url)
+		);
+		derived.With(Int("status", data.request.status)).Info("new data");
+	}
+};
+
 struct GLogLogger {
 	GLogLogger(const char *argv0) {
 		FLAGS_logtostderr = false;
@@ -133,6 +233,11 @@ int main(int argc, char **argv) {
 
 	Benchmarker<BenchmarkData, 103> benchmarker;
 
+	std::cout << "sizeof(slog::Value) = " << sizeof(slog::Value)
+	          << ", sizeof(slog::Attribute) = " << sizeof(slog::Attribute)
+	          << ", sizeof(slog::details::Record<6>) = "
+	          << sizeof(slog::details::Record<6>) << std::endl;
+
 	std::cout << benchmarker.Benchmark("Noop", NoopFunctor()) << std::endl;
 
 	std::cout
@@ -159,6 +264,24 @@ int main(int argc, char **argv) {
 	             )
 	          << std::endl;
 
+	std::cout << benchmarker.Benchmark(
+	                 "slog++ - JSON - Typed",
+	                 SlogTypedLogger(slog::WithFileOutput(
+	                     "/dev/null",
+	                     slog::FromLevel(slog::Level::Info)
+	                 ))
+	             )
+	          << std::endl;
+
+	std::cout << benchmarker.Benchmark(
+	                 "slog++ - JSON - Planned",
+	                 SlogPlannedLogger(slog::WithFileOutput(
+	                     "/dev/null",
+	                     slog::FromLevel(slog::Level::Info)
+	                 ))
+	             )
+	          << std::endl;
+
 	std::cout << benchmarker.Benchmark(
 	                 "slog++ - JSON - Derived",
 	                 SlogDerivedLogger(slog::WithFileOutput(
@@ -168,6 +291,12 @@ int main(int argc, char **argv) {
 	             )
 	          << std::endl;
 
+	std::cout << benchmarker.Benchmark(
+	                 "slog++ - Attribute copies",
+	                 SlogCopies()
+	             )
+	          << std::endl;
+
 	std::cout
 	    << benchmarker.Benchmark("Google GLog - Text", GLogLogger(argv[0]))
 	    << std::endl;
@@ -0,0 +1,42 @@
+#include "AllocationCounterTest.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// The replacement allocator is defined apart from the tests, so that its
+// malloc() and free() calls are not inlined in their code.
+
+static thread_local size_t s_allocations = 0;
+
+void *operator new(size_t size) {
+	++s_allocations;
+	if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+		return ptr;
+	}
+	throw std::bad_alloc{};
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+	++s_allocations;
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+	std::free(ptr);
+}
+
+namespace slog {
+
+size_t ThreadAllocations() noexcept {
+	return s_allocations;
+}
+
+} // namespace slog
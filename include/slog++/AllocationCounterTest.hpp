@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+namespace slog {
+
+// Returns the number of calls of the calling thread to the global allocator,
+// which the tests replace with a counting one.
+size_t ThreadAllocations() noexcept;
+
+} // namespace slog
@@ -2,9 +2,15 @@
 
 #include "Types.hpp"
 
+#include <algorithm>
+#include <concepts>
+#include <string>
+#include <string_view>
 #include <type_traits>
 #include <variant>
+#include <vector>
 
+#include "details/BlockCache.hpp"
 #include "utils/Array.hpp"
 #include "utils/ContainerReference.hpp"
 
@@ -48,20 +54,34 @@ struct Attribute {
 	bool       operator==(const Attribute &other) const noexcept;
 
 	inline constexpr bool empty() const noexcept {
-		return std::holds_alternative<std::monostate>(value);
+		return holds_alternative<std::monostate>(value);
 	}
 };
 
+#ifdef SLOGPP_COMPACT_VALUE
+static_assert(
+    sizeof(Attribute) == 40,
+    "a compact Attribute should fit in 40 bytes"
+);
+#endif
+
 namespace details {
 
 template <size_t N> class GroupData : public Group {
 public:
 	template <typename... Attributes>
+	    requires(!std::is_same_v<std::decay_t<Attributes>, GroupData> && ...)
 	inline GroupData(Attributes &&...attributes)
 	    : d_data{std::forward<Attributes>(attributes)...} {
 		this->attributes = utils::ContainerReference<Attribute>(d_data);
 	};
 
+	// non-copyable non-movable, as attributes references d_data.
+	GroupData(const GroupData &)            = delete;
+	GroupData(GroupData &&)                 = delete;
+	GroupData &operator=(const GroupData &) = delete;
+	GroupData &operator=(GroupData &&)      = delete;
+
 private:
 	details::Array<Attribute, N> d_data;
 };
@@ -78,6 +98,128 @@ public:
 private:
 	std::vector<Attribute> d_data;
 };
+
+// The attribute returned by StringView(). A logger writing to a sink
+// allocating its records on the stack only references the string, otherwise
+// it converts to an Attribute owning a copy of it.
+class StringViewAttribute {
+public:
+	template <typename Str>
+	inline StringViewAttribute(Str &&key, std::string_view value) noexcept
+	    : key{std::forward<Str>(key)}
+	    , value{value} {}
+
+	inline operator Attribute() const & {
+		return Attribute{key, StringType{std::string{value}}};
+	}
+
+	inline operator Attribute() && {
+		return Attribute{std::move(key), StringType{std::string{value}}};
+	}
+
+	// Returns an attribute referencing the string, which must outlive it.
+	inline Attribute Borrow() const {
+		return Attribute{key, StringRef{value}};
+	}
+
+	StringType       key;
+	std::string_view value;
+};
+
+// A string literal usable as a template argument, such as the key of a Field.
+template <size_t N> struct FixedString {
+	inline constexpr FixedString(const char (&str)[N]) noexcept {
+		std::copy_n(str, N, data);
+	}
+
+	inline constexpr std::string_view View() const noexcept {
+		return std::string_view{data, N - 1};
+	}
+
+	// a template argument object has static storage, it is only referenced.
+	inline constexpr StaticString Static() const noexcept {
+		return StaticString{data, N - 1};
+	}
+
+	char data[N];
+};
+
+// The attribute returned by Int<"key">() and the other factories taking their
+// key as a template argument. Its key and type being known at compile time, a
+// logger typed with JSONFormatter encodes it through a JSONPlan, without
+// building an Attribute. Otherwise, it converts to an Attribute, and string
+// values are borrowed as StringViewAttribute does.
+template <FixedString Key, typename T> struct Field {
+	using ValueType = T;
+
+	inline constexpr static std::string_view Name() noexcept {
+		return Key.View();
+	}
+
+	inline operator Attribute() const {
+		if constexpr (std::is_same_v<T, std::string_view>) {
+			return Attribute{Key.Static(), StringType{std::string{value}}};
+		} else {
+			return Attribute{Key.Static(), value};
+		}
+	}
+
+	// Returns an attribute referencing a string value, which must outlive it.
+	inline Attribute Borrow() const {
+		if constexpr (std::is_same_v<T, std::string_view>) {
+			return Attribute{Key.Static(), StringRef{value}};
+		} else {
+			return Attribute{Key.Static(), value};
+		}
+	}
+
+	T value;
+};
+
+template <typename T> struct isField : std::false_type {};
+
+template <FixedString Key, typename T>
+struct isField<Field<Key, T>> : std::true_type {};
+
+template <typename T>
+concept FieldAttribute = isField<std::decay_t<T>>::value;
+
+template <typename T>
+concept Borrowable = requires(const T &attribute) {
+	{ attribute.Borrow() } -> std::same_as<Attribute>;
+};
+
+// Returns attribute, referencing its group without owning it, so that it
+// must outlive the result.
+inline Attribute borrowGroup(const Attribute &attribute) {
+	if (holds_alternative<GroupPtr>(attribute.value) == false) {
+		return attribute;
+	}
+	auto *group = get<GroupPtr>(attribute.value).get();
+	return Attribute{attribute.key, GroupPtr{GroupPtr{}, group}};
+}
+
+inline Attribute borrowGroup(Attribute &&attribute) {
+	if (holds_alternative<GroupPtr>(attribute.value) == false) {
+		return std::move(attribute);
+	}
+	// attribute keeps owning the group.
+	auto *group = get<GroupPtr>(attribute.value).get();
+	return Attribute{std::move(attribute.key), GroupPtr{GroupPtr{}, group}};
+}
+
+// Forwards attribute to a record on the stack, which does not outlive it. It
+// is borrowed if it is Borrowable, and its group, if any, is referenced
+// without touching its reference count.
+template <typename T> inline decltype(auto) borrow(T &&attribute) {
+	if constexpr (Borrowable<std::decay_t<T>>) {
+		return attribute.Borrow();
+	} else if constexpr (std::is_same_v<std::decay_t<T>, Attribute>) {
+		return borrowGroup(std::forward<T>(attribute));
+	} else {
+		return std::forward<T>(attribute);
+	}
+}
 } // namespace details
 
 template <typename Str> Attribute Bool(Str &&key, bool value);
@@ -116,6 +258,10 @@ constexpr Attribute Time(Str &&key, Timepoint &&timepoint) noexcept;
 template <typename Str, typename... Attributes>
 constexpr Attribute Group(Str &&key, Attributes &&...attributes) noexcept;
 
+template <typename Str>
+details::StringViewAttribute
+StringView(Str &&key, std::string_view value) noexcept;
+
 template <typename Str, typename Iter, typename MapFunc>
 constexpr Attribute MapContainer(
     Str &&key, const Iter &begin, const Iter &end, const MapFunc &mapper
@@ -136,11 +282,46 @@ template <typename E>
     requires std::derived_from<std::decay_t<E>, std::exception>
 constexpr Attribute Err(const E &e) noexcept;
 
+// Attributes whose key is a string literal, such as Int<"code">(code). See
+// details::Field.
+template <details::FixedString Key>
+constexpr details::Field<Key, bool> Bool(bool value) noexcept;
+
+template <
+    details::FixedString Key,
+    typename Integer,
+    std::enable_if_t<std::is_integral_v<std::decay_t<Integer>>> * = nullptr>
+constexpr details::Field<Key, int64_t> Int(Integer value) noexcept;
+
+template <
+    details::FixedString Key,
+    typename Floating,
+    std::enable_if_t<std::is_floating_point_v<Floating>> * = nullptr>
+constexpr details::Field<Key, double> Float(Floating value) noexcept;
+
+template <details::FixedString Key>
+constexpr details::Field<Key, std::string_view>
+StringView(std::string_view value) noexcept;
+
+template <
+    details::FixedString Key,
+    typename DurationType,
+    std::enable_if_t<details::is_duration_castable<DurationType>::value> * =
+        nullptr>
+constexpr details::Field<Key, DurationT> Duration(DurationType &&value
+) noexcept;
+
+template <
+    details::FixedString Key,
+    typename Timepoint,
+    std::enable_if_t<details::is_time_castable<Timepoint>::value> * = nullptr>
+constexpr details::Field<Key, TimeT> Time(Timepoint &&timepoint) noexcept;
+
 } // namespace slog
 
 #if __cplusplus >= 202002L
 namespace slog {
-constexpr Attribute Location(
+SLOGPP_ATTRIBUTE_CONSTEXPR Attribute Location(
     const std::source_location location = std::source_location::current()
 ) noexcept {
 	return Group(
@@ -68,10 +68,71 @@ Group(Str &&key, Attributes &&...attributes) noexcept {
 	    sizeof...(Attributes) >= 1,
 	    "A Group should always have at least one attribute"
 	);
+	// the block of a group logged on the stack is reused by the next one.
 	using Array = details::GroupData<sizeof...(Attributes)>;
 	return Attribute{
 	    std::forward<Str>(key),
-	    std::make_shared<Array>(std::forward<Attributes>(attributes)...),
+	    std::allocate_shared<Array>(
+	        details::BlockAllocator<Array>{},
+	        std::forward<Attributes>(attributes)...
+	    ),
+	};
+}
+
+template <typename Str>
+inline details::StringViewAttribute
+StringView(Str &&key, std::string_view value) noexcept {
+	return details::StringViewAttribute{std::forward<Str>(key), value};
+}
+
+template <details::FixedString Key>
+inline constexpr details::Field<Key, bool> Bool(bool value) noexcept {
+	return details::Field<Key, bool>{value};
+}
+
+template <
+    details::FixedString Key,
+    typename Integer,
+    std::enable_if_t<std::is_integral_v<std::decay_t<Integer>>> *>
+inline constexpr details::Field<Key, int64_t> Int(Integer value) noexcept {
+	return details::Field<Key, int64_t>{int64_t(value)};
+}
+
+template <
+    details::FixedString Key,
+    typename Floating,
+    std::enable_if_t<std::is_floating_point_v<Floating>> *>
+inline constexpr details::Field<Key, double> Float(Floating value) noexcept {
+	return details::Field<Key, double>{double(value)};
+}
+
+template <details::FixedString Key>
+inline constexpr details::Field<Key, std::string_view>
+StringView(std::string_view value) noexcept {
+	return details::Field<Key, std::string_view>{value};
+}
+
+template <
+    details::FixedString Key,
+    typename DurationType,
+    std::enable_if_t<details::is_duration_castable<DurationType>::value> *>
+inline constexpr details::Field<Key, DurationT>
+Duration(DurationType &&value) noexcept {
+	using namespace std::chrono;
+	return details::Field<Key, DurationT>{
+	    duration_cast<DurationT>(std::forward<DurationType>(value)),
+	};
+}
+
+template <
+    details::FixedString Key,
+    typename Timepoint,
+    std::enable_if_t<details::is_time_castable<Timepoint>::value> *>
+inline constexpr details::Field<Key, TimeT> Time(Timepoint &&timepoint
+) noexcept {
+	using namespace std::chrono;
+	return details::Field<Key, TimeT>{
+	    time_point_cast<DurationT>(std::forward<Timepoint>(timepoint)),
 	};
 }
 
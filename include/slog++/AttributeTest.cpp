@@ -14,20 +14,20 @@ TEST_F(AttributeTest, Location) {
 	auto loc = Location();
 	EXPECT_EQ(loc.key, "location");
 	EXPECT_NO_THROW({
-		const auto &group = *std::get<GroupPtr>(loc.value);
+		const auto &group = *get<GroupPtr>(loc.value);
 		ASSERT_EQ(group.attributes.size(), 3);
 		EXPECT_EQ(group.attributes[0].key, "function");
 		EXPECT_STREQ(
-		    std::get<StringType>(group.attributes[0].value).c_str(),
+		    get<StringType>(group.attributes[0].value).c_str(),
 		    "virtual void slog::AttributeTest_Location_Test::TestBody()"
 		);
 		EXPECT_EQ(group.attributes[1].key, "file");
 		EXPECT_THAT(
-		    std::get<StringType>(group.attributes[1].value).c_str(),
+		    get<StringType>(group.attributes[1].value).c_str(),
 		    ::testing::EndsWith("include/slog++/AttributeTest.cpp")
 		);
 		EXPECT_EQ(group.attributes[2].key, "line");
-		EXPECT_EQ(std::get<long>(group.attributes[2].value), 14);
+		EXPECT_EQ(get<long>(group.attributes[2].value), 14);
 	});
 }
 
@@ -36,8 +36,8 @@ template <typename T> void testInteger(const std::string &key, T &&value) {
 	auto a = Int(key, std::forward<T>(value));
 
 	EXPECT_EQ(a.key, key);
-	EXPECT_NO_THROW({ EXPECT_EQ(std::get<int64_t>(a.value), value); });
-	EXPECT_THROW(std::get<bool>(a.value), std::bad_variant_access);
+	EXPECT_NO_THROW({ EXPECT_EQ(get<int64_t>(a.value), value); });
+	EXPECT_THROW(get<bool>(a.value), std::bad_variant_access);
 }
 
 TEST_F(AttributeTest, Int) {
@@ -56,8 +56,8 @@ template <typename T> void testFloating(const std::string &key, T &&value) {
 	auto a = Float(key, value);
 
 	EXPECT_EQ(a.key, key);
-	EXPECT_NO_THROW({ EXPECT_EQ(std::get<double>(a.value), value); });
-	EXPECT_THROW(std::get<bool>(a.value), std::bad_variant_access);
+	EXPECT_NO_THROW({ EXPECT_EQ(get<double>(a.value), value); });
+	EXPECT_THROW(get<bool>(a.value), std::bad_variant_access);
 }
 
 TEST_F(AttributeTest, Float) {
@@ -68,8 +68,8 @@ TEST_F(AttributeTest, Float) {
 TEST_F(AttributeTest, Bool) {
 	auto a = Bool("bool", true);
 	EXPECT_EQ(a.key, "bool");
-	EXPECT_NO_THROW(EXPECT_EQ(std::get<bool>(a.value), true));
-	EXPECT_THROW(std::get<double>(a.value), std::bad_variant_access);
+	EXPECT_NO_THROW(EXPECT_EQ(get<bool>(a.value), true));
+	EXPECT_THROW(get<double>(a.value), std::bad_variant_access);
 }
 
 template <typename T> void testString(const std::string &key, T &&value) {
@@ -79,14 +79,14 @@ template <typename T> void testString(const std::string &key, T &&value) {
 	EXPECT_EQ(a.key, key);
 	if constexpr (std::is_same_v<T, const char *>) {
 		EXPECT_NO_THROW({
-			EXPECT_STREQ(std::get<StringType>(a.value).c_str(), value);
+			EXPECT_STREQ(get<StringType>(a.value).c_str(), value);
 		});
 	} else if constexpr (std::is_same_v<T, std::string>) {
 		EXPECT_NO_THROW({
-			EXPECT_STREQ(std::get<StringType>(a.value).c_str(), value.c_str());
+			EXPECT_STREQ(get<StringType>(a.value).c_str(), value.c_str());
 		});
 	}
-	EXPECT_THROW(std::get<bool>(a.value), std::bad_variant_access);
+	EXPECT_THROW(get<bool>(a.value), std::bad_variant_access);
 }
 
 TEST_F(AttributeTest, String) {
@@ -98,7 +98,7 @@ TEST_F(AttributeTest, DurationT) {
 	auto a = Duration("duration", std::chrono::hours(1));
 	EXPECT_EQ(a.key, "duration");
 	EXPECT_NO_THROW(
-	    EXPECT_EQ(std::get<DurationT>(a.value), std::chrono::hours(1))
+	    EXPECT_EQ(get<DurationT>(a.value), std::chrono::hours(1))
 	);
 }
 
@@ -107,7 +107,7 @@ TEST_F(AttributeTest, Pointer) {
 	auto p       = Pointer("pointer", pointer.get());
 	EXPECT_EQ(p.key, "pointer");
 	EXPECT_NO_THROW({
-		EXPECT_EQ(std::get<void *>(p.value), (void *)pointer.get());
+		EXPECT_EQ(get<void *>(p.value), (void *)pointer.get());
 	});
 }
 
@@ -120,7 +120,7 @@ TEST_F(AttributeTest, TimeT) {
 
 	EXPECT_EQ(a.key, "time");
 	EXPECT_NO_THROW({
-		auto time = std::get<TimeT>(a.value);
+		auto time = get<TimeT>(a.value);
 		EXPECT_EQ(
 		    time,
 		    std::chrono::time_point_cast<DurationT>(oneDayAfterEpoch)
@@ -137,15 +137,15 @@ TEST_F(AttributeTest, Group) {
 	);
 	EXPECT_EQ(a.key, "group");
 	EXPECT_NO_THROW({
-		const auto &group = *std::get<GroupPtr>(a.value);
+		const auto &group = *get<GroupPtr>(a.value);
 		ASSERT_EQ(group.attributes.size(), 2);
 		EXPECT_EQ(group.attributes[0].key, "request");
 		EXPECT_STREQ(
-		    std::get<StringType>(group.attributes[0].value).c_str(),
+		    get<StringType>(group.attributes[0].value).c_str(),
 		    "https://example.com"
 		);
 		EXPECT_EQ(group.attributes[1].key, "status");
-		EXPECT_EQ(std::get<int64_t>(group.attributes[1].value), 200);
+		EXPECT_EQ(get<int64_t>(group.attributes[1].value), 200);
 	});
 }
 
@@ -160,11 +160,11 @@ TEST_F(AttributeTest, Mapping) {
 	);
 	EXPECT_EQ(a.key, "group");
 	EXPECT_NO_THROW({
-		const auto &group = *std::get<GroupPtr>(a.value);
+		const auto &group = *get<GroupPtr>(a.value);
 		ASSERT_EQ(group.attributes.size(), 4);
 		for (size_t i = 0; i < 4; ++i) {
 			EXPECT_EQ(group.attributes[i].key, "#" + std::to_string(i));
-			EXPECT_EQ(std::get<int64_t>(group.attributes[i].value), data[i]);
+			EXPECT_EQ(get<int64_t>(group.attributes[i].value), data[i]);
 		}
 	});
 }
@@ -16,12 +16,48 @@ enum class OutputFormat {
 	TEXT = 1,
 };
 
+/**
+ * Behavior of an async sink when its queue is full.
+ */
+enum class OverflowPolicy {
+	// waits for room in the queue, up to the block timeout.
+	Block      = 0,
+	// drops the record being logged.
+	DropNewest = 1,
+	// evicts the oldest queued record.
+	DropOldest = 2,
+	// keeps one record out of sampleRate, which blocks like Block, and drops
+	// the others.
+	Sample     = 3,
+};
+
 struct BaseSinkConfig {
 
-	bool                        withLocking = false;
-	bool                        async       = false;
-	OutputFormat                format      = OutputFormat::JSON;
+	bool                        withLocking        = false;
+	bool                        async              = false;
+	bool                        perThreadQueues    = false;
+	// async sinks queue encoded stack records, formatted by the consumer.
+	bool                        deferredFormatting = false;
+	OutputFormat                format             = OutputFormat::JSON;
 	std::array<bool, NumLevels> levels;
+	// 0 uses the default capacity.
+	size_t                      queueCapacity   = 0;
+	OverflowPolicy              overflowPolicy  = OverflowPolicy::Block;
+	DurationT                   blockTimeout    = DurationT::max();
+	size_t                      sampleRate      = 1;
+	// limits of the batches written at once by an async sink.
+	size_t                      batchRecords    = 256;
+	size_t                      batchBytes      = 64 * 1024;
+	// async sinks consume their records on their own thread, optionally
+	// pinned to writerCpus, instead of the shared thread pool.
+	bool                        dedicatedWriter = false;
+	std::vector<size_t>         writerCpus;
+	// async sinks queue the records from priorityLevel in a separate queue,
+	// always drained first, or write them on the logging thread if
+	// prioritySynchronous is set.
+	bool                        priorityLane        = false;
+	Level                       priorityLevel       = Level::Error;
+	bool                        prioritySynchronous = false;
 
 	BaseSinkConfig() {
 		levels.fill(false);
@@ -46,7 +82,15 @@ using SinkConfig = std::variant<ProgramOutputSinkConfig, FileSinkConfig>;
 
 struct Config {
 	std::vector<SinkConfig> sinks;
-	size_t                  threadPoolSize = 0;
+	// the size of details::threadPool, consuming the records of the async
+	// sinks without a dedicated writer. Set to 1 by Sanitize() if they need
+	// it.
+	size_t                  threadPoolSize    = 0;
+	// if positive, async sinks are drained at exit for up to this duration.
+	DurationT               exitDrainTimeout  = DurationT::zero();
+	// limits of the pool of formatting buffers, 0 for no limit.
+	size_t                  bufferPoolObjects = 0;
+	size_t                  bufferPoolBytes   = 0;
 };
 
 template <typename T> using Option = std::function<void(T &)>;
@@ -55,6 +99,30 @@ Option<BaseSinkConfig> WithLocking();
 
 Option<BaseSinkConfig> WithAsync();
 
+Option<BaseSinkConfig> WithPerThreadQueues();
+
+Option<BaseSinkConfig> WithDeferredFormatting();
+
+Option<BaseSinkConfig> WithQueueCapacity(size_t capacity);
+
+Option<BaseSinkConfig> WithOverflowPolicy(OverflowPolicy policy);
+
+Option<BaseSinkConfig> WithBlockTimeout(DurationT timeout);
+
+Option<BaseSinkConfig> WithSampleRate(size_t rate);
+
+Option<BaseSinkConfig> WithBatchLimits(size_t records, size_t bytes);
+
+// Makes the sink async, consuming its records on a thread of its own instead
+// of the shared thread pool, and pins this thread to cpus if any.
+// Throws std::invalid_argument if cpus cannot be pinned on this platform. The
+// sink construction throws std::runtime_error if the writer is not pinned.
+Option<BaseSinkConfig> WithDedicatedWriter(std::vector<size_t> cpus = {});
+
+Option<BaseSinkConfig> WithPriorityLane(Level from = Level::Error);
+
+Option<BaseSinkConfig> WithSynchronousPriority(Level from = Level::Error);
+
 Option<BaseSinkConfig> WithFormat(OutputFormat format);
 
 Option<BaseSinkConfig> FromLevel(Level level);
@@ -76,6 +144,10 @@ Option<Config> WithFileOutput(std::string filename, const Configs &...configs);
 
 Option<Config> WithThreadPoolSize(size_t size);
 
+Option<Config> WithDrainOnExit(DurationT timeout = std::chrono::seconds(1));
+
+Option<Config> WithBufferPoolLimits(size_t objects, size_t bytes);
+
 namespace details {
 void Sanitize(Config &config);
 }
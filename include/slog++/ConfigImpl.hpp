@@ -3,6 +3,10 @@
 #include "Config.hpp"
 #include "Formatters.hpp"
 #include "Level.hpp"
+#include "utils/ThreadPool.hpp"
+
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 
 #ifdef _WIN32
@@ -21,6 +25,83 @@ inline Option<BaseSinkConfig> WithAsync() {
 	return [](BaseSinkConfig &config) { config.async = true; };
 }
 
+inline Option<BaseSinkConfig> WithPerThreadQueues() {
+	return [](BaseSinkConfig &config) {
+		config.async           = true;
+		config.perThreadQueues = true;
+	};
+}
+
+inline Option<BaseSinkConfig> WithDeferredFormatting() {
+	return [](BaseSinkConfig &config) {
+		config.async              = true;
+		config.deferredFormatting = true;
+	};
+}
+
+inline Option<BaseSinkConfig> WithQueueCapacity(size_t capacity) {
+	return [capacity](BaseSinkConfig &config) {
+		config.queueCapacity = capacity;
+	};
+}
+
+inline Option<BaseSinkConfig> WithOverflowPolicy(OverflowPolicy policy) {
+	return [policy](BaseSinkConfig &config) { config.overflowPolicy = policy; };
+}
+
+inline Option<BaseSinkConfig> WithBlockTimeout(DurationT timeout) {
+	return [timeout](BaseSinkConfig &config) {
+		config.blockTimeout = timeout;
+	};
+}
+
+inline Option<BaseSinkConfig> WithSampleRate(size_t rate) {
+	return [rate](BaseSinkConfig &config) {
+		config.overflowPolicy = OverflowPolicy::Sample;
+		config.sampleRate     = rate;
+	};
+}
+
+inline Option<BaseSinkConfig> WithBatchLimits(size_t records, size_t bytes) {
+	return [records, bytes](BaseSinkConfig &config) {
+		config.batchRecords = records;
+		config.batchBytes   = bytes;
+	};
+}
+
+inline Option<BaseSinkConfig> WithDedicatedWriter(std::vector<size_t> cpus) {
+	for (auto cpu : cpus) {
+		if (!utils::ThreadPool::ValidCPU(cpu)) {
+			throw std::invalid_argument(
+			    "cannot pin a writer to CPU " + std::to_string(cpu)
+			);
+		}
+	}
+	return [cpus = std::move(cpus)](BaseSinkConfig &config) {
+		config.async           = true;
+		config.dedicatedWriter = true;
+		config.writerCpus      = cpus;
+	};
+}
+
+inline Option<BaseSinkConfig> WithPriorityLane(Level from) {
+	return [from](BaseSinkConfig &config) {
+		config.async               = true;
+		config.priorityLane        = true;
+		config.priorityLevel       = from;
+		config.prioritySynchronous = false;
+	};
+}
+
+inline Option<BaseSinkConfig> WithSynchronousPriority(Level from) {
+	return [from](BaseSinkConfig &config) {
+		config.async               = true;
+		config.priorityLane        = true;
+		config.priorityLevel       = from;
+		config.prioritySynchronous = true;
+	};
+}
+
 inline Option<BaseSinkConfig> WithFormat(OutputFormat format) {
 	return [format](BaseSinkConfig &config) { config.format = format; };
 }
@@ -92,6 +173,17 @@ inline Option<Config> WithThreadPoolSize(size_t size) {
 	return [size](Config &config) { config.threadPoolSize = size; };
 }
 
+inline Option<Config> WithDrainOnExit(DurationT timeout) {
+	return [timeout](Config &config) { config.exitDrainTimeout = timeout; };
+}
+
+inline Option<Config> WithBufferPoolLimits(size_t objects, size_t bytes) {
+	return [objects, bytes](Config &config) {
+		config.bufferPoolObjects = objects;
+		config.bufferPoolBytes   = bytes;
+	};
+}
+
 namespace details {
 
 inline void Sanitize(Config &config) {
@@ -103,11 +195,14 @@ inline void Sanitize(Config &config) {
 		);
 	}
 
-	// if async sync are needed, set wanted threadpool size.
+	// if async sync are needed, set wanted threadpool size. Sinks with a
+	// dedicated writer do not need it.
 	bool hasAsync =
 	    std::find_if(config.sinks.begin(), config.sinks.end(), [](auto &&sink) {
 		    return std::visit(
-		        [](auto &&s) -> bool { return s.async; },
+		        [](auto &&s) -> bool {
+			        return s.async && s.dedicatedWriter == false;
+		        },
 		        std::forward<decltype(sink)>(sink)
 		    );
 	    }) != config.sinks.end();
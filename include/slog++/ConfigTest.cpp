@@ -12,6 +12,19 @@ TEST(BaseSinkConfig, Default) {
 	BaseSinkConfig defaultValue{};
 	EXPECT_FALSE(defaultValue.withLocking);
 	EXPECT_FALSE(defaultValue.async);
+	EXPECT_FALSE(defaultValue.perThreadQueues);
+	EXPECT_FALSE(defaultValue.deferredFormatting);
+	EXPECT_EQ(defaultValue.queueCapacity, 0);
+	EXPECT_EQ(defaultValue.overflowPolicy, OverflowPolicy::Block);
+	EXPECT_EQ(defaultValue.blockTimeout, DurationT::max());
+	EXPECT_EQ(defaultValue.sampleRate, 1);
+	EXPECT_EQ(defaultValue.batchRecords, 256);
+	EXPECT_EQ(defaultValue.batchBytes, 64 * 1024);
+	EXPECT_FALSE(defaultValue.dedicatedWriter);
+	EXPECT_THAT(defaultValue.writerCpus, ::testing::IsEmpty());
+	EXPECT_FALSE(defaultValue.priorityLane);
+	EXPECT_EQ(defaultValue.priorityLevel, Level::Error);
+	EXPECT_FALSE(defaultValue.prioritySynchronous);
 	EXPECT_EQ(defaultValue.format, OutputFormat::JSON);
 	for (auto enabled : defaultValue.levels) {
 		EXPECT_FALSE(enabled);
@@ -47,7 +60,64 @@ auto BasicSinkConfigEqual(const BaseSinkConfig &config) {
 	        Eq(config.withLocking)
 	    ),
 	    Field("async", &BaseSinkConfig::async, Eq(config.async)),
+	    Field(
+	        "perThreadQueues",
+	        &BaseSinkConfig::perThreadQueues,
+	        Eq(config.perThreadQueues)
+	    ),
+	    Field(
+	        "deferredFormatting",
+	        &BaseSinkConfig::deferredFormatting,
+	        Eq(config.deferredFormatting)
+	    ),
 	    Field("format", &BaseSinkConfig::format, Eq(config.format)),
+	    Field(
+	        "queueCapacity",
+	        &BaseSinkConfig::queueCapacity,
+	        Eq(config.queueCapacity)
+	    ),
+	    Field(
+	        "overflowPolicy",
+	        &BaseSinkConfig::overflowPolicy,
+	        Eq(config.overflowPolicy)
+	    ),
+	    Field(
+	        "blockTimeout",
+	        &BaseSinkConfig::blockTimeout,
+	        Eq(config.blockTimeout)
+	    ),
+	    Field("sampleRate", &BaseSinkConfig::sampleRate, Eq(config.sampleRate)),
+	    Field(
+	        "batchRecords",
+	        &BaseSinkConfig::batchRecords,
+	        Eq(config.batchRecords)
+	    ),
+	    Field("batchBytes", &BaseSinkConfig::batchBytes, Eq(config.batchBytes)),
+	    Field(
+	        "dedicatedWriter",
+	        &BaseSinkConfig::dedicatedWriter,
+	        Eq(config.dedicatedWriter)
+	    ),
+	    Field(
+	        "writerCpus",
+	        &BaseSinkConfig::writerCpus,
+	        ElementsAreArray(config.writerCpus)
+	    ),
+	    Field(
+	        "priorityLane",
+	        &BaseSinkConfig::priorityLane,
+	        Eq(config.priorityLane)
+	    ),
+	    Field(
+	        "priorityLevel",
+	        &BaseSinkConfig::priorityLevel,
+	        Eq(config.priorityLevel)
+	    ),
+	    Field(
+	        "prioritySynchronous",
+	        &BaseSinkConfig::prioritySynchronous,
+	        Eq(config.prioritySynchronous)
+	    ),
 	    Field(
 	        "levels",
 	        &BaseSinkConfig::levels,
@@ -74,6 +144,106 @@ TEST(BaseSinkConfig, Options) {
 	        WithAsync(),
 	        buildBaseSinkConfig(false, true, OutputFormat::JSON, {}),
 	    },
+	    {
+	        "WithPerThreadQueues",
+	        WithPerThreadQueues(),
+	        [] {
+		        auto config =
+		            buildBaseSinkConfig(false, true, OutputFormat::JSON, {});
+		        config.perThreadQueues = true;
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithDeferredFormatting",
+	        WithDeferredFormatting(),
+	        [] {
+		        auto config =
+		            buildBaseSinkConfig(false, true, OutputFormat::JSON, {});
+		        config.deferredFormatting = true;
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithQueueCapacity",
+	        WithQueueCapacity(64),
+	        [] {
+		        BaseSinkConfig config{};
+		        config.queueCapacity = 64;
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithOverflowPolicy",
+	        WithOverflowPolicy(OverflowPolicy::DropOldest),
+	        [] {
+		        BaseSinkConfig config{};
+		        config.overflowPolicy = OverflowPolicy::DropOldest;
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithBlockTimeout",
+	        WithBlockTimeout(std::chrono::milliseconds(10)),
+	        [] {
+		        BaseSinkConfig config{};
+		        config.blockTimeout = std::chrono::milliseconds(10);
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithSampleRate",
+	        WithSampleRate(8),
+	        [] {
+		        BaseSinkConfig config{};
+		        config.overflowPolicy = OverflowPolicy::Sample;
+		        config.sampleRate     = 8;
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithBatchLimits",
+	        WithBatchLimits(16, 4096),
+	        [] {
+		        BaseSinkConfig config{};
+		        config.batchRecords = 16;
+		        config.batchBytes   = 4096;
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithDedicatedWriter",
+	        WithDedicatedWriter({0, 2}),
+	        [] {
+		        auto config =
+		            buildBaseSinkConfig(false, true, OutputFormat::JSON, {});
+		        config.dedicatedWriter = true;
+		        config.writerCpus      = {0, 2};
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithPriorityLane",
+	        WithPriorityLane(Level::Warn),
+	        [] {
+		        auto config =
+		            buildBaseSinkConfig(false, true, OutputFormat::JSON, {});
+		        config.priorityLane  = true;
+		        config.priorityLevel = Level::Warn;
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithSynchronousPriority",
+	        WithSynchronousPriority(),
+	        [] {
+		        auto config =
+		            buildBaseSinkConfig(false, true, OutputFormat::JSON, {});
+		        config.priorityLane        = true;
+		        config.prioritySynchronous = true;
+		        return config;
+	        }(),
+	    },
 	    {
 	        "WithFormat",
 	        WithFormat(OutputFormat::TEXT),
@@ -196,6 +366,10 @@ TEST(ProgramOutputSinkConfig, Config) {
 TEST(Config, Default) {
 	Config config{};
 	EXPECT_THAT(config.sinks, ::testing::IsEmpty());
+	EXPECT_EQ(config.threadPoolSize, 0);
+	EXPECT_EQ(config.exitDrainTimeout, DurationT::zero());
+	EXPECT_EQ(config.bufferPoolObjects, 0);
+	EXPECT_EQ(config.bufferPoolBytes, 0);
 }
 
 template <typename... Sinks>
@@ -244,10 +418,32 @@ MATCHER(SinkConfigTupleAreEqual, "") {
 
 auto ConfigAreEqual(const Config &config) {
 	using namespace ::testing;
-	return Field(
-	    "sinks",
-	    &Config::sinks,
-	    Pointwise(SinkConfigTupleAreEqual(), config.sinks)
+	return AllOf(
+	    Field(
+	        "sinks",
+	        &Config::sinks,
+	        Pointwise(SinkConfigTupleAreEqual(), config.sinks)
+	    ),
+	    Field(
+	        "threadPoolSize",
+	        &Config::threadPoolSize,
+	        Eq(config.threadPoolSize)
+	    ),
+	    Field(
+	        "exitDrainTimeout",
+	        &Config::exitDrainTimeout,
+	        Eq(config.exitDrainTimeout)
+	    ),
+	    Field(
+	        "bufferPoolObjects",
+	        &Config::bufferPoolObjects,
+	        Eq(config.bufferPoolObjects)
+	    ),
+	    Field(
+	        "bufferPoolBytes",
+	        &Config::bufferPoolBytes,
+	        Eq(config.bufferPoolBytes)
+	    )
 	);
 }
 
@@ -289,6 +485,25 @@ TEST(Config, Options) {
 	        WithThreadPoolSize(2),
 	        buildConfig(2),
 	    },
+	    {
+	        "WithDrainOnExit",
+	        WithDrainOnExit(std::chrono::milliseconds(200)),
+	        [] {
+		        auto config             = buildConfig(0);
+		        config.exitDrainTimeout = std::chrono::milliseconds(200);
+		        return config;
+	        }(),
+	    },
+	    {
+	        "WithBufferPoolLimits",
+	        WithBufferPoolLimits(64, 1 << 20),
+	        [] {
+		        auto config              = buildConfig(0);
+		        config.bufferPoolObjects = 64;
+		        config.bufferPoolBytes   = 1 << 20;
+		        return config;
+	        }(),
+	    },
 	    {
 	        "Complex",
 	        ConcatOptions<Config>(
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "Level.hpp"
+#include "details/LevelMask.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+namespace slog {
+
+/**
+ * An attribute for EmergencyLog(). Unlike Attribute, it never allocates: its
+ * key and string value are only referenced, and must outlive the call.
+ */
+struct EmergencyAttribute {
+	enum class Type { Bool, Int, Float, String, Pointer };
+
+	constexpr EmergencyAttribute(const char *key, bool value) noexcept
+	    : key{key}
+	    , type{Type::Bool}
+	    , boolean{value} {}
+
+	template <
+	    typename Integer,
+	    std::enable_if_t<
+	        std::is_integral_v<Integer> && !std::is_same_v<Integer, bool>> * =
+	        nullptr>
+	constexpr EmergencyAttribute(const char *key, Integer value) noexcept
+	    : key{key}
+	    , type{Type::Int}
+	    , integer{int64_t(value)} {}
+
+	template <
+	    typename Floating,
+	    std::enable_if_t<std::is_floating_point_v<Floating>> * = nullptr>
+	constexpr EmergencyAttribute(const char *key, Floating value) noexcept
+	    : key{key}
+	    , type{Type::Float}
+	    , floating{double(value)} {}
+
+	constexpr EmergencyAttribute(const char *key, const char *value) noexcept
+	    : key{key}
+	    , type{Type::String}
+	    , string{value} {}
+
+	constexpr EmergencyAttribute(const char *key, const void *value) noexcept
+	    : key{key}
+	    , type{Type::Pointer}
+	    , pointer{value} {}
+
+	constexpr EmergencyAttribute(const char *key, std::nullptr_t) noexcept
+	    : key{key}
+	    , type{Type::Pointer}
+	    , pointer{nullptr} {}
+
+	const char *key;
+	Type        type;
+
+	union {
+		bool        boolean;
+		int64_t     integer;
+		double      floating;
+		const char *string;
+		const void *pointer;
+	};
+};
+
+/**
+ * Logs a record from a context where only async-signal-safe functions may be
+ * called, such as a signal handler. The record is formatted in a preallocated
+ * buffer per output, and written with write(2) to every registered file sink
+ * enabling level, or to stderr if there are none. It is written right away,
+ * before any record still queued by an asynchronous sink.
+ *
+ * Example:
+ *     slog::EmergencyLog(
+ *         slog::Level::Fatal,
+ *         "caught signal",
+ *         {{"signal", signum}, {"address", info->si_addr}}
+ *     );
+ */
+void EmergencyLog(
+    Level                                     level,
+    const char                               *message,
+    std::initializer_list<EmergencyAttribute> attributes = {}
+) noexcept;
+
+// The number of outputs EmergencyLog() can write to, that is of file sinks
+// alive at the same time. The file sinks built beyond it still log, but are
+// not written to by EmergencyLog().
+#ifndef SLOGPP_MAX_EMERGENCY_OUTPUTS
+#define SLOGPP_MAX_EMERGENCY_OUTPUTS 8
+#endif
+
+namespace details {
+
+enum class EmergencyFormat { Text, JSON };
+
+// The registered outputs of EmergencyLog(), with their preallocated buffer.
+struct EmergencyOutput {
+	constexpr static int    Free       = -1;
+	constexpr static int    Reserved   = -2;
+	constexpr static size_t BufferSize = 4096;
+	constexpr static size_t MaxOutputs = SLOGPP_MAX_EMERGENCY_OUTPUTS;
+
+	std::atomic<int> fd{Free};
+	EmergencyFormat  format = EmergencyFormat::Text;
+	// the levels of the registering sink, all of them if null.
+	const LevelMask *levels = nullptr;
+	std::atomic_flag busy;
+	char             buffer[BufferSize]{};
+};
+
+inline EmergencyOutput emergencyOutputs[EmergencyOutput::MaxOutputs];
+
+// Registers fd as an output of EmergencyLog() for the lifetime of the object,
+// for the levels enabled in levels, which must outlive it, or all of them if
+// null.
+class EmergencyRegistration {
+public:
+	inline EmergencyRegistration() noexcept = default;
+
+	EmergencyRegistration(
+	    int fd, EmergencyFormat format, const LevelMask *levels = nullptr
+	) noexcept;
+
+	inline ~EmergencyRegistration() {
+		reset();
+	}
+
+	inline EmergencyRegistration(EmergencyRegistration &&other) noexcept
+	    : d_output{other.d_output} {
+		other.d_output = nullptr;
+	}
+
+	inline EmergencyRegistration &operator=(EmergencyRegistration &&other
+	) noexcept {
+		reset();
+		d_output       = other.d_output;
+		other.d_output = nullptr;
+		return *this;
+	}
+
+	EmergencyRegistration(const EmergencyRegistration &)            = delete;
+	EmergencyRegistration &operator=(const EmergencyRegistration &) = delete;
+
+	// Returns false if fd could not be registered, as the MaxOutputs outputs
+	// are all in use.
+	inline bool Registered() const noexcept {
+		return d_output != nullptr;
+	}
+
+private:
+	inline void reset() noexcept {
+		if (d_output != nullptr) {
+			// waits for a concurrent EmergencyLog() to be done with the fd
+			// and the buffer, before they can be closed or reused.
+			auto &output = *d_output;
+			while (output.busy.test_and_set(std::memory_order_acquire)) {
+			}
+			output.fd.store(EmergencyOutput::Free, std::memory_order_release);
+			output.busy.clear(std::memory_order_release);
+			d_output = nullptr;
+		}
+	}
+
+	EmergencyOutput *d_output = nullptr;
+};
+
+} // namespace details
+
+} // namespace slog
+
+#include "EmergencyImpl.hpp"
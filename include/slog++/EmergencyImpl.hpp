@@ -0,0 +1,382 @@
+#pragma once
+
+#include "Emergency.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace slog {
+
+namespace details {
+
+inline EmergencyRegistration::EmergencyRegistration(
+    int fd, EmergencyFormat format, const LevelMask *levels
+) noexcept {
+	if (fd < 0) {
+		return;
+	}
+	for (auto &output : emergencyOutputs) {
+		int expected = EmergencyOutput::Free;
+		if (output.fd.compare_exchange_strong(
+		        expected,
+		        EmergencyOutput::Reserved,
+		        std::memory_order_acquire
+		    ) == false) {
+			continue;
+		}
+		output.format = format;
+		output.levels = levels;
+		output.fd.store(fd, std::memory_order_release);
+		d_output = &output;
+		return;
+	}
+}
+
+// A fixed size buffer that silently truncates what does not fit. data must
+// hold one byte more than capacity, for EndLine(). Only uses async-signal-safe
+// operations.
+class EmergencyBuffer {
+public:
+	inline EmergencyBuffer(char *data, size_t capacity) noexcept
+	    : d_data{data}
+	    , d_capacity{capacity} {}
+
+	inline void Append(const char *str, size_t length) noexcept {
+		length = std::min(length, d_capacity - d_size);
+		std::memcpy(d_data + d_size, str, length);
+		d_size += length;
+	}
+
+	inline void Append(const char *str) noexcept {
+		Append(str, std::strlen(str));
+	}
+
+	inline void Append(char c) noexcept {
+		Append(&c, 1);
+	}
+
+	// Terminates the record, in the byte reserved past the capacity, so that
+	// a truncated record does not run into the next one.
+	inline void EndLine() noexcept {
+		d_data[d_size++] = '\n';
+	}
+
+	template <typename T>
+	inline void AppendNumber(T value, int base = 10) noexcept {
+		char tmp[32];
+		std::to_chars_result res;
+		if constexpr (std::is_floating_point_v<T>) {
+			res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+		} else {
+			res = std::to_chars(tmp, tmp + sizeof(tmp), value, base);
+		}
+		Append(tmp, res.ptr - tmp);
+	}
+
+	// Appends value with exactly width digits.
+	inline void AppendDigits(int64_t value, size_t width) noexcept {
+		char tmp[20];
+		for (size_t i = width; i > 0; --i) {
+			tmp[i - 1] = '0' + char(value % 10);
+			value /= 10;
+		}
+		Append(tmp, width);
+	}
+
+	inline const char *Data() const noexcept {
+		return d_data;
+	}
+
+	inline size_t Size() const noexcept {
+		return d_size;
+	}
+
+private:
+	char        *d_data;
+	const size_t d_capacity;
+	size_t       d_size = 0;
+};
+
+inline const char *emergencyLevelName(Level level) noexcept {
+	constexpr static const char *names[NumLevels] = {
+	    "UNKNOWN",                                  //
+	    "TRACE",   "TRACE_1", "TRACE_2", "TRACE_3", //
+	    "DEBUG",   "DEBUG_1", "DEBUG_2", "DEBUG_3", //
+	    "INFO",    "INFO_1",  "INFO_2",  "INFO_3",  //
+	    "WARN",    "WARN_1",  "WARN_2",  "WARN_3",  //
+	    "ERROR",   "ERROR_1", "ERROR_2", "ERROR_3", //
+	    "FATAL",
+	};
+	size_t idx(size_t(level) + 1);
+	if (idx >= NumLevels) {
+		return names[0];
+	}
+	return names[idx];
+}
+
+// Formats the current time as RFC3339, as FormatTo(const TimeT&) but without
+// gmtime() which is not async-signal-safe.
+inline void emergencyFormatTime(EmergencyBuffer &buffer) noexcept {
+	struct timespec now {};
+#ifdef _WIN32
+	timespec_get(&now, TIME_UTC);
+#else
+	clock_gettime(CLOCK_REALTIME, &now);
+#endif
+	int64_t days = now.tv_sec / 86400;
+	int64_t secs = now.tv_sec % 86400;
+
+	// H. Hinnant's civil_from_days().
+	days += 719468;
+	const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+	const int64_t doe = days - era * 146097;
+	const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const int64_t mp  = (5 * doy + 2) / 153;
+	const int64_t d   = doy - (153 * mp + 2) / 5 + 1;
+	const int64_t m   = mp < 10 ? mp + 3 : mp - 9;
+	const int64_t y   = yoe + era * 400 + (m <= 2);
+
+	buffer.AppendDigits(y, 4);
+	buffer.Append('-');
+	buffer.AppendDigits(m, 2);
+	buffer.Append('-');
+	buffer.AppendDigits(d, 2);
+	buffer.Append('T');
+	buffer.AppendDigits(secs / 3600, 2);
+	buffer.Append(':');
+	buffer.AppendDigits((secs / 60) % 60, 2);
+	buffer.Append(':');
+	buffer.AppendDigits(secs % 60, 2);
+	buffer.Append('.');
+	int64_t nanos = now.tv_nsec;
+	if (nanos % 1000000 == 0) {
+		buffer.AppendDigits(nanos / 1000000, 3);
+	} else if (nanos % 1000 == 0) {
+		buffer.AppendDigits(nanos / 1000, 6);
+	} else {
+		buffer.AppendDigits(nanos, 9);
+	}
+	buffer.Append('Z');
+}
+
+inline void emergencyFormatString(
+    const char *str, EmergencyFormat format, EmergencyBuffer &buffer
+) noexcept {
+	if (str == nullptr) {
+		str = "";
+	}
+	const size_t length = std::strlen(str);
+	if (format == EmergencyFormat::Text) {
+		bool quote = false;
+		for (size_t i = 0; i < length; ++i) {
+			// the characters std::isspace() matches in the C locale.
+			const char c = str[i];
+			quote        = quote || c == ' ' || (c >= '\t' && c <= '\r');
+		}
+		if (quote) {
+			buffer.Append('\"');
+		}
+		for (size_t i = 0; i < length; ++i) {
+			if (str[i] == '\"' && (i == 0 || str[i - 1] != '\\')) {
+				buffer.Append('\\');
+			}
+			buffer.Append(str[i]);
+		}
+		if (quote) {
+			buffer.Append('\"');
+		}
+		return;
+	}
+
+	constexpr static char hexDigits[] = "0123456789abcdef";
+	buffer.Append('\"');
+	for (size_t i = 0; i < length; ++i) {
+		unsigned char c = str[i];
+		switch (c) {
+		case '\"':
+			buffer.Append("\\\"");
+			break;
+		case '\\':
+			buffer.Append("\\\\");
+			break;
+		case '\n':
+			buffer.Append("\\n");
+			break;
+		case '\t':
+			buffer.Append("\\t");
+			break;
+		case '\r':
+			buffer.Append("\\r");
+			break;
+		default:
+			if (c < 0x20) {
+				buffer.Append("\\u00");
+				buffer.Append(hexDigits[c >> 4]);
+				buffer.Append(hexDigits[c & 0xf]);
+			} else {
+				buffer.Append(char(c));
+			}
+		}
+	}
+	buffer.Append('\"');
+}
+
+inline void emergencyFormatValue(
+    const EmergencyAttribute &attribute,
+    EmergencyFormat           format,
+    EmergencyBuffer          &buffer
+) noexcept {
+	const bool quoted = format == EmergencyFormat::JSON;
+	switch (attribute.type) {
+	case EmergencyAttribute::Type::Bool:
+		buffer.Append(attribute.boolean ? "true" : "false");
+		break;
+	case EmergencyAttribute::Type::Int:
+		buffer.AppendNumber(attribute.integer);
+		break;
+	case EmergencyAttribute::Type::Float:
+		buffer.AppendNumber(attribute.floating);
+		break;
+	case EmergencyAttribute::Type::String:
+		emergencyFormatString(attribute.string, format, buffer);
+		break;
+	case EmergencyAttribute::Type::Pointer:
+		if (quoted) {
+			buffer.Append('\"');
+		}
+		if (attribute.pointer == nullptr) {
+			buffer.Append("nullptr");
+		} else {
+			buffer.Append("0x");
+			buffer.AppendNumber(uintptr_t(attribute.pointer), 16);
+		}
+		if (quoted) {
+			buffer.Append('\"');
+		}
+		break;
+	}
+}
+
+// Formats the record as RecordToRawText() or RecordToJSON() would.
+inline void emergencyFormat(
+    Level                                     level,
+    const char                               *message,
+    std::initializer_list<EmergencyAttribute> attributes,
+    EmergencyFormat                           format,
+    EmergencyBuffer                          &buffer
+) noexcept {
+	if (format == EmergencyFormat::Text) {
+		emergencyFormatTime(buffer);
+		buffer.Append(' ');
+		buffer.Append(emergencyLevelName(level));
+		buffer.Append(' ');
+		emergencyFormatString(message, format, buffer);
+		for (const auto &attribute : attributes) {
+			buffer.Append(' ');
+			buffer.Append(attribute.key);
+			buffer.Append('=');
+			emergencyFormatValue(attribute, format, buffer);
+		}
+	} else {
+		buffer.Append("{\"time\":\"");
+		emergencyFormatTime(buffer);
+		buffer.Append("\",\"level\":\"");
+		buffer.Append(emergencyLevelName(level));
+		buffer.Append("\",\"message\":");
+		emergencyFormatString(message, format, buffer);
+		for (const auto &attribute : attributes) {
+			buffer.Append(',');
+			emergencyFormatString(attribute.key, format, buffer);
+			buffer.Append(':');
+			emergencyFormatValue(attribute, format, buffer);
+		}
+		buffer.Append('}');
+	}
+}
+
+inline void emergencyWrite(int fd, const char *data, size_t size) noexcept {
+	while (size > 0) {
+#ifdef _WIN32
+		auto written = _write(fd, data, unsigned(size));
+#else
+		auto written = ::write(fd, data, size);
+#endif
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return;
+		}
+		data += written;
+		size -= written;
+	}
+}
+
+} // namespace details
+
+inline void EmergencyLog(
+    Level                                     level,
+    const char                               *message,
+    std::initializer_list<EmergencyAttribute> attributes
+) noexcept {
+	using namespace details;
+
+	// errno must be preserved by signal handlers.
+	const int savedErrno = errno;
+	bool      written    = false;
+	for (auto &output : emergencyOutputs) {
+		if (output.fd.load(std::memory_order_relaxed) < 0) {
+			continue;
+		}
+		// the buffer may be in use by a concurrent or interrupted call.
+		if (output.busy.test_and_set(std::memory_order_acquire)) {
+			continue;
+		}
+		// the output cannot be unregistered while busy.
+		int fd = output.fd.load(std::memory_order_acquire);
+		if (fd < 0) {
+			output.busy.clear(std::memory_order_release);
+			continue;
+		}
+		if (output.levels != nullptr && !output.levels->Enabled(level)) {
+			// filtered out by its sink, not to be written to stderr either.
+			output.busy.clear(std::memory_order_release);
+			written = true;
+			continue;
+		}
+		EmergencyBuffer buffer(output.buffer, EmergencyOutput::BufferSize - 1);
+		emergencyFormat(level, message, attributes, output.format, buffer);
+		buffer.EndLine();
+		emergencyWrite(fd, buffer.Data(), buffer.Size());
+		output.busy.clear(std::memory_order_release);
+		written = true;
+	}
+
+	if (written == false) {
+		// formats on the stack, as no preallocated buffer can be used.
+		char            data[1024];
+		EmergencyBuffer buffer(data, sizeof(data) - 1);
+		emergencyFormat(
+		    level,
+		    message,
+		    attributes,
+		    EmergencyFormat::Text,
+		    buffer
+		);
+		buffer.EndLine();
+		emergencyWrite(2, buffer.Data(), buffer.Size());
+	}
+	errno = savedErrno;
+}
+
+} // namespace slog
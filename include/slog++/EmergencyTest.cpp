@@ -0,0 +1,209 @@
+#include "Emergency.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace slog {
+
+class EmergencyTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		ASSERT_EQ(pipe(d_pipe), 0);
+	}
+
+	void TearDown() override {
+		close(d_pipe[0]);
+		close(d_pipe[1]);
+	}
+
+	int writeEnd() const {
+		return d_pipe[1];
+	}
+
+	std::string read() {
+		char buffer[4096];
+		auto size = ::read(d_pipe[0], buffer, sizeof(buffer));
+		return size > 0 ? std::string(buffer, size) : std::string{};
+	}
+
+private:
+	int d_pipe[2];
+};
+
+const static std::string rfc3339 =
+    "[0-9]{4}-[0-9]{2}-[0-9]{2}T[0-9]{2}:[0-9]{2}:[0-9]{2}.[0-9]{3,9}Z";
+
+TEST_F(EmergencyTest, Text) {
+	details::EmergencyRegistration registration(
+	    writeEnd(),
+	    details::EmergencyFormat::Text
+	);
+
+	int value = 0;
+	EmergencyLog(
+	    Level::Fatal,
+	    "emergency stop",
+	    {{"signal", 11},
+	     {"ratio", 0.5},
+	     {"fatal", true},
+	     {"reason", "out of memory"},
+	     {"address", &value},
+	     {"null", nullptr}}
+	);
+	EXPECT_THAT(
+	    read(),
+	    ::testing::MatchesRegex(
+	        "^" + rfc3339 +
+	        R"--( FATAL "emergency stop" signal=11 ratio=0.5 fatal=true )--"
+	        R"--(reason="out of memory" address=0x[0-9a-f]+ null=nullptr)--"
+	        "\n$"
+	    )
+	);
+}
+
+TEST_F(EmergencyTest, JSON) {
+	details::EmergencyRegistration registration(
+	    writeEnd(),
+	    details::EmergencyFormat::JSON
+	);
+
+	EmergencyLog(
+	    Level::Error,
+	    "with \"quotes\"\n",
+	    {{"signal", 11}, {"a \"key\"", 1}}
+	);
+	EXPECT_THAT(
+	    read(),
+	    ::testing::MatchesRegex(
+	        R"--(^\{"time":")--" + rfc3339 +
+	        R"--(","level":"ERROR","message":"with \\"quotes\\"\\n",)--"
+	        R"--("signal":11,"a \\"key\\"":1\})--"
+	        "\n$"
+	    )
+	);
+}
+
+TEST_F(EmergencyTest, TruncatedRecordsEndTheLine) {
+	details::EmergencyRegistration registration(
+	    writeEnd(),
+	    details::EmergencyFormat::Text
+	);
+
+	const std::string message(2 * details::EmergencyOutput::BufferSize, 'a');
+	EmergencyLog(Level::Error, message.c_str());
+	const auto written = read();
+	EXPECT_EQ(written.size(), details::EmergencyOutput::BufferSize);
+	EXPECT_THAT(written, ::testing::EndsWith("aaa\n"));
+}
+
+TEST_F(EmergencyTest, SkipsDisabledLevels) {
+	std::array<bool, NumLevels> levels{};
+	details::LevelMask          mask{levels};
+	mask.From(Level::Error);
+	details::EmergencyRegistration registration(
+	    writeEnd(),
+	    details::EmergencyFormat::Text,
+	    &mask
+	);
+
+	// neither written to the output, nor to stderr. The default logger may
+	// also have registered stderr, below Info.
+	::testing::internal::CaptureStderr();
+	EmergencyLog(Level::Debug, "filtered");
+	EXPECT_EQ(::testing::internal::GetCapturedStderr(), "");
+	EmergencyLog(Level::Error, "kept");
+	EXPECT_THAT(read(), ::testing::EndsWith(" ERROR kept\n"));
+}
+
+TEST_F(EmergencyTest, ReportsTooManyOutputs) {
+	std::vector<details::EmergencyRegistration> registrations;
+	for (size_t i = 0; i <= details::EmergencyOutput::MaxOutputs; ++i) {
+		registrations.emplace_back(writeEnd(), details::EmergencyFormat::Text);
+		if (registrations.back().Registered() == false) {
+			break;
+		}
+	}
+	EXPECT_FALSE(registrations.back().Registered());
+
+	registrations.pop_back();
+	registrations.pop_back();
+	// an output is freed by the last registration.
+	details::EmergencyRegistration freed(
+	    writeEnd(),
+	    details::EmergencyFormat::Text
+	);
+	EXPECT_TRUE(freed.Registered());
+}
+
+TEST_F(EmergencyTest, Unregisters) {
+	{
+		details::EmergencyRegistration registration(
+		    writeEnd(),
+		    details::EmergencyFormat::Text
+		);
+	}
+	for (const auto &output : details::emergencyOutputs) {
+		EXPECT_NE(output.fd.load(), writeEnd());
+	}
+}
+
+TEST_F(EmergencyTest, UnregisterWaitsForWriters) {
+	details::EmergencyRegistration registration(
+	    writeEnd(),
+	    details::EmergencyFormat::Text
+	);
+	details::EmergencyOutput *output = nullptr;
+	for (auto &o : details::emergencyOutputs) {
+		if (o.fd.load() == writeEnd()) {
+			output = &o;
+		}
+	}
+	ASSERT_NE(output, nullptr);
+
+	// as an EmergencyLog() call writing to the output.
+	output->busy.test_and_set();
+	std::atomic<bool> done{false};
+	std::thread       unregister{[&registration, &done]() {
+		registration = details::EmergencyRegistration{};
+		done         = true;
+	}};
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_FALSE(done);
+	EXPECT_EQ(output->fd.load(), writeEnd());
+
+	output->busy.clear();
+	unregister.join();
+	EXPECT_EQ(output->fd.load(), details::EmergencyOutput::Free);
+}
+
+TEST_F(EmergencyTest, FromSignalHandler) {
+	details::EmergencyRegistration registration(
+	    writeEnd(),
+	    details::EmergencyFormat::Text
+	);
+
+	auto previous = std::signal(SIGUSR1, [](int signum) {
+		EmergencyLog(Level::Fatal, "caught signal", {{"signal", signum}});
+	});
+	std::raise(SIGUSR1);
+	std::signal(SIGUSR1, previous);
+
+	EXPECT_THAT(
+	    read(),
+	    ::testing::EndsWith(
+	        "FATAL \"caught signal\" signal=" + std::to_string(SIGUSR1) + "\n"
+	    )
+	);
+}
+
+} // namespace slog
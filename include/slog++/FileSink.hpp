@@ -1,8 +1,16 @@
 #pragma once
 
 #include "Config.hpp"
+#include "Emergency.hpp"
 #include "SinkDetails.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstdio>
+#include <system_error>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 namespace slog {
 
@@ -12,16 +20,17 @@ public:
 	using Base = details::Sink<FileSink, CM>;
 
 	inline FileSink(const FileSinkConfig &config)
-	    : Base(config.levels, config.Formatter()) {
+	    : Base(config, config.Formatter()) {
 		auto file = std::fopen(config.filepath.c_str(), "a");
 		if (file == nullptr) {
 			throw std::system_error(errno, std::generic_category());
 		}
 		d_file = FilePtr(file, [](FILE *f) { std::fclose(f); });
+		registerEmergency(config);
 	}
 
 	inline FileSink(const ProgramOutputSinkConfig &config)
-	    : Base(config.levels, config.Formatter()) {
+	    : Base(config, config.Formatter()) {
 		FILE *outputStream = nullptr;
 #ifdef _WIN32
 		// On Windows, stdout/stderr are macros, so we use the underlying
@@ -32,6 +41,7 @@ public:
 		outputStream = config.toStdout ? stdout : stderr;
 #endif
 		d_file = FilePtr(outputStream, [](FILE *f) {});
+		registerEmergency(config);
 	}
 
 	void Log(const Buffer &buffer) {
@@ -39,11 +49,61 @@ public:
 		std::fputc('\n', d_file.get());
 	}
 
+	// Writes many newline terminated records at once. Returns the number of
+	// records that could not be fully written.
+	size_t LogBatch(const Buffer &batch) {
+#ifdef _WIN32
+		const auto written =
+		    std::fwrite(batch.data(), sizeof(char), batch.size(), d_file.get());
+		return std::count(batch.begin() + written, batch.end(), '\n');
+#else
+		// The batch is written with a single syscall, bypassing the stream
+		// buffer. It must first be flushed to keep the records in order.
+		// Partial writes are resumed.
+		std::fflush(d_file.get());
+		const char *data      = batch.data();
+		size_t      remaining = batch.size();
+		while (remaining > 0) {
+			auto written = ::write(fileno(d_file.get()), data, remaining);
+			if (written < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				// the record being written is lost with the following ones.
+				return std::count(data, data + remaining, '\n');
+			}
+			data += written;
+			remaining -= written;
+		}
+		return 0;
+#endif
+	}
+
+	void FlushOutput() {
+		std::fflush(d_file.get());
+	}
+
 private:
 	using FileCloser = std::function<void(std::FILE *)>;
 	using FilePtr    = std::unique_ptr<std::FILE, FileCloser>;
 
-	FilePtr d_file;
+	// makes the file an output of EmergencyLog(), for the levels of the sink.
+	// Beyond SLOGPP_MAX_EMERGENCY_OUTPUTS live file sinks, the file is left
+	// unregistered: the emergency path is best effort, and must not prevent
+	// ordinary logging.
+	inline void registerEmergency(const BaseSinkConfig &config) {
+		const auto format = config.format == OutputFormat::JSON
+		                        ? details::EmergencyFormat::JSON
+		                        : details::EmergencyFormat::Text;
+		d_emergency       = details::EmergencyRegistration(
+		    fileno(d_file.get()),
+		    format,
+		    this->EnabledLevels()
+		);
+	}
+
+	FilePtr                        d_file;
+	details::EmergencyRegistration d_emergency;
 };
 
 } // namespace slog
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Attribute.hpp"
 #include "Types.hpp"
 #include <string>
 
@@ -11,6 +12,34 @@ void RecordToRawText(const Record &record, Buffer &);
 
 void RecordToANSIText(const Record &record, Buffer &);
 
+// The formatters above as types, to format the records of a typed Logger
+// without an indirect call.
+struct JSONFormatter {
+	inline void operator()(const Record &record, Buffer &buffer) const {
+		RecordToJSON(record, buffer);
+	}
+
+	// Formats record followed by fields, through a plan of their encoding
+	// computed at compile time.
+	template <typename... Fields>
+	    requires(details::FieldAttribute<Fields> && ...)
+	void operator()(
+	    const Record &record, Buffer &buffer, const Fields &...fields
+	) const;
+};
+
+struct RawTextFormatter {
+	inline void operator()(const Record &record, Buffer &buffer) const {
+		RecordToRawText(record, buffer);
+	}
+};
+
+struct ANSITextFormatter {
+	inline void operator()(const Record &record, Buffer &buffer) const {
+		RecordToANSIText(record, buffer);
+	}
+};
+
 } // namespace slog
 
 #include "FormattersImpl.hpp"
@@ -5,11 +5,13 @@
 #include "Level.hpp"
 #include "Record.hpp"
 #include "Types.hpp"
+#include <array>
 #include <cctype>
 #include <charconv>
 #include <ctime>
 #include <limits>
 #include <type_traits>
+#include <utility>
 #include <variant>
 
 namespace slog {
@@ -54,7 +56,7 @@ inline void FormatTo(double value, Buffer &buffer) {
 	}
 }
 
-inline void TextFormatTo(const StringType &value, Buffer &buffer) {
+inline void TextFormatTo(std::string_view value, Buffer &buffer) {
 	bool quote = std::find_if(value.begin(), value.end(), [](char c) {
 		             return std::isspace(c) != 0;
 	             }) != value.end();
@@ -79,10 +81,10 @@ inline void TextFormatTo(const StringType &value, Buffer &buffer) {
 
 inline void FormatTo(void *pointer, Buffer &buffer) {
 	if (pointer == nullptr) {
-		TextFormatTo("nullptr", buffer);
+		buffer += "nullptr";
 		return;
 	}
-	TextFormatTo("0x", buffer);
+	buffer += "0x";
 	auto startSize = buffer.size();
 	while (true) {
 		buffer.resize(buffer.size() + 32); // may reallocate
@@ -99,7 +101,7 @@ inline void FormatTo(void *pointer, Buffer &buffer) {
 	}
 }
 
-inline bool needEscaping(const StringType &value) noexcept {
+inline bool needEscaping(std::string_view value) noexcept {
 	return std::any_of(value.begin(), value.end(), [](unsigned char c) {
 		return c == '\\' || c == '\"' || c < 0x20 || c > 0x7f;
 	});
@@ -134,12 +136,12 @@ inline void appendHex(uint16_t ch, Buffer &buffer) {
 	buffer.push_back(hexDigits[2 * lower + 1]);
 }
 
-inline void JSONFormatTo(const StringType &value, Buffer &buffer) {
+inline void JSONFormatTo(std::string_view value, Buffer &buffer) {
 	buffer.reserve(buffer.size() + value.size() + 2);
 	buffer.push_back('\"');
 
 	if (!needEscaping(value)) {
-		SLOGPP_appendToBuffer(buffer, value);
+		buffer += value;
 		buffer.push_back('\"');
 		return;
 	}
@@ -182,6 +184,68 @@ inline void JSONFormatTo(const StringType &value, Buffer &buffer) {
 	buffer.push_back('\"');
 }
 
+// Appends key to out, escaped for a JSON string.
+template <typename Writer>
+inline constexpr void escapeJSONKey(std::string_view key, Writer &out) {
+	constexpr char hexDigits[] = "0123456789abcdef";
+	for (char ch : key) {
+		switch (ch) {
+		case '\"':
+			out.Append("\\\"");
+			break;
+		case '\\':
+			out.Append("\\\\");
+			break;
+		case '\b':
+			out.Append("\\b");
+			break;
+		case '\f':
+			out.Append("\\f");
+			break;
+		case '\n':
+			out.Append("\\n");
+			break;
+		case '\r':
+			out.Append("\\r");
+			break;
+		case '\t':
+			out.Append("\\t");
+			break;
+		default:
+			if (ch >= 0 && ch < 0x20) {
+				out.Append("\\u00");
+				out.Push(hexDigits[ch >> 4]);
+				out.Push(hexDigits[ch & 0xf]);
+			} else {
+				out.Push(ch);
+			}
+		}
+	}
+}
+
+// Writes a runtime key to a Buffer, as SkeletonWriter does for a planned one.
+struct BufferWriter {
+	inline void Push(char ch) {
+		buffer.push_back(ch);
+	}
+
+	inline void Append(std::string_view str) {
+		buffer += str;
+	}
+
+	Buffer &buffer;
+};
+
+// Appends key to buffer, escaped as the keys planned by JSONPlan.
+inline void JSONKeyTo(std::string_view key, Buffer &buffer) {
+	if (!needEscaping(key)) {
+		buffer += key;
+		return;
+	}
+	BufferWriter out{buffer};
+	escapeJSONKey(key, out);
+}
+
 inline void FormatTo(const DurationT &duration, Buffer &buffer) {
 	constexpr static int64_t us = 1000;
 	constexpr static int64_t ms = 1000 * us;
@@ -412,7 +476,7 @@ template <class> inline constexpr bool always_false_v = false;
 inline void attributeToJSON(
     const Attribute &attribute, Buffer &buffer, const std::string &sep
 ) {
-	std::visit(
+	visit(
 	    [&buffer, &key = attribute.key, &sep](auto &&arg) {
 		    using T = std::decay_t<decltype(arg)>; // cast away references
 		    if constexpr (std::is_same_v<T, std::monostate>) {
@@ -420,7 +484,7 @@ inline void attributeToJSON(
 		    } else if constexpr (std::is_same_v<T, GroupPtr>) { // Is it a
 			                                                    // group
 			    buffer += sep + "\"";
-			    SLOGPP_appendToBuffer(buffer, key);
+			    details::JSONKeyTo(viewOf(key), buffer);
 			    buffer += "\":";
 			    bool once = true;
 			    for (const auto &attr : arg->attributes) {
@@ -428,22 +492,22 @@ inline void attributeToJSON(
 				    once = false;
 			    }
 			    buffer += "}";
-		    } else if constexpr (std::is_same_v<T,
-		                                        StringType>) { // formatter
+		    } else if constexpr (std::is_same_v<T, StringType> ||
+		                         std::is_same_v<T, StringRef>) { // formatter
 			    buffer += sep + "\"";
-			    SLOGPP_appendToBuffer(buffer, key);
+			    details::JSONKeyTo(viewOf(key), buffer);
 			    buffer += "\":";
-			    details::JSONFormatTo(std::forward<decltype(arg)>(arg), buffer);
+			    details::JSONFormatTo(viewOf(arg), buffer);
 		    } else if constexpr (std::is_same_v<T, bool> ||
 		                         std::is_same_v<T, int64_t> ||
 		                         std::is_same_v<T, double>) {
 			    buffer += sep + "\"";
-			    SLOGPP_appendToBuffer(buffer, key);
+			    details::JSONKeyTo(viewOf(key), buffer);
 			    buffer += "\":";
 			    details::FormatTo(std::forward<decltype(arg)>(arg), buffer);
 		    } else {
 			    buffer += sep + "\"";
-			    SLOGPP_appendToBuffer(buffer, key);
+			    details::JSONKeyTo(viewOf(key), buffer);
 			    buffer += "\":\"";
 			    details::FormatTo(std::forward<decltype(arg)>(arg), buffer);
 			    buffer += "\"";
@@ -458,7 +522,7 @@ inline void attributeToText(
 ) {
 	auto name = groupPrefix;
 	SLOGPP_appendToBuffer(name, attribute.key);
-	std::visit(
+	visit(
 	    [&buffer, &name](auto &&arg) {
 		    using T = std::decay_t<decltype(arg)>; // cast away references
 		    if constexpr (std::is_same_v<T, std::monostate>) {
@@ -469,9 +533,10 @@ inline void attributeToText(
 			    for (const auto &attr : arg->attributes) {
 				    attributeToText(attr, prefix, buffer);
 			    }
-		    } else if constexpr (std::is_same_v<T, StringType>) {
+		    } else if constexpr (std::is_same_v<T, StringType> ||
+		                         std::is_same_v<T, StringRef>) {
 			    buffer += " " + name += "=";
-			    details::TextFormatTo(std::forward<decltype(arg)>(arg), buffer);
+			    details::TextFormatTo(viewOf(arg), buffer);
 		    } else { // formatter
 			    buffer += " " + name + "=";
 			    details::FormatTo(std::forward<decltype(arg)>(arg), buffer);
@@ -489,7 +554,7 @@ inline void attributeToTree(
 ) {
 	std::string prefix = parentPrefix + (isLast ? "└── " : "├── ");
 
-	std::visit(
+	visit(
 	    [&, prefix, parentIsLast = isLast](auto &&arg) {
 		    using T = std::decay_t<decltype(arg)>; // cast away references
 		    if constexpr (std::is_same_v<T, std::monostate>) {
@@ -507,11 +572,12 @@ inline void attributeToTree(
 				    bool isLast = ++index == arg->attributes.size();
 				    attributeToTree(attr, newTreePrefix, isLast, buffer);
 			    }
-		    } else if constexpr (std::is_same_v<T, StringType>) {
+		    } else if constexpr (std::is_same_v<T, StringType> ||
+		                         std::is_same_v<T, StringRef>) {
 			    buffer += prefix;
 			    SLOGPP_appendToBuffer(buffer, attribute.key);
 			    buffer += "=";
-			    details::TextFormatTo(std::forward<decltype(arg)>(arg), buffer);
+			    details::TextFormatTo(viewOf(arg), buffer);
 
 		    } else {
 			    buffer += prefix;
@@ -524,21 +590,167 @@ inline void attributeToTree(
 	);
 }
 
-} // namespace details
+// Appends the context of record encoded in format.
+template <typename Render>
+inline void appendContext(
+    const slog::Record &record,
+    Context::Format     format,
+    Buffer             &buffer,
+    Render            &&render
+) {
+	if (record.context) {
+		buffer += record.context->Encoded(format, std::forward<Render>(render));
+	}
+}
 
-inline void RecordToJSON(const Record &record, std::string &buffer) {
+// Appends record to buffer as a JSON object, left open for more attributes.
+inline void openJSON(const slog::Record &record, Buffer &buffer) {
 	buffer += "{\"time\":\"";
-	details::FormatTo(record.timestamp, buffer);
+	FormatTo(record.timestamp, buffer);
 
-	buffer += "\",\"level\":\"" + details::levelName(record.level) + "\"";
+	buffer += "\",\"level\":\"" + levelName(record.level) + "\"";
 
 	buffer += ",\"message\":";
-	details::JSONFormatTo(record.message, buffer);
+	JSONFormatTo(viewOf(record.message), buffer);
+
+	appendContext(
+	    record,
+	    Context::Format::JSON,
+	    buffer,
+	    [](const Attribute &attribute, Buffer &buffer) {
+		    attributeToJSON(attribute, buffer, ",");
+	    }
+	);
+	for (const auto &attribute : record.attributes) {
+		attributeToJSON(attribute, buffer, ",");
+	}
+}
+
+// The characters of a JSONPlan skeleton, split in Fragments, or only their
+// count if Capacity is 0.
+template <size_t Capacity, size_t Fragments> struct SkeletonWriter {
+	inline constexpr void Push(char ch) noexcept {
+		if constexpr (Capacity > 0) {
+			data[size] = ch;
+		}
+		++size;
+	}
 
-	for (const Attribute &attribute : record.attributes) {
-		details::attributeToJSON(attribute, buffer, ",");
+	inline constexpr void Append(std::string_view str) noexcept {
+		for (char ch : str) {
+			Push(ch);
+		}
 	}
 
+	inline constexpr void EndFragment() noexcept {
+		ends[fragment++] = size;
+	}
+
+	std::array<char, Capacity>    data{};
+	std::array<size_t, Fragments> ends{};
+	size_t                        size     = 0;
+	size_t                        fragment = 0;
+};
+
+// durations and times are quoted, as by attributeToJSON().
+template <typename T>
+constexpr bool quotedInJSON =
+    std::is_same_v<T, DurationT> || std::is_same_v<T, TimeT>;
+
+// Writes the constant parts of the JSON encoding of Fields to out: each
+// fragment ends before the value of a field, and the last one ends the
+// encoding.
+template <typename... Fields, typename Writer>
+inline constexpr void writeJSONSkeleton(Writer &out) {
+	bool quoted = false;
+	(
+	    [&out, &quoted]() {
+		    if (quoted) {
+			    out.Push('\"');
+		    }
+		    out.Append(",\"");
+		    escapeJSONKey(Fields::Name(), out);
+		    out.Append("\":");
+		    quoted = quotedInJSON<typename Fields::ValueType>;
+		    if (quoted) {
+			    out.Push('\"');
+		    }
+		    out.EndFragment();
+	    }(),
+	    ...
+	);
+	if (quoted) {
+		out.Push('\"');
+	}
+	out.EndFragment();
+}
+
+template <typename... Fields> inline constexpr auto planJSON() {
+	constexpr size_t Fragments = sizeof...(Fields) + 1;
+	constexpr size_t Size      = []() {
+		SkeletonWriter<0, Fragments> counter;
+		writeJSONSkeleton<Fields...>(counter);
+		return counter.size;
+	}();
+
+	SkeletonWriter<Size, Fragments> out;
+	writeJSONSkeleton<Fields...>(out);
+	return out;
+}
+
+template <typename T> inline void fieldToJSON(const T &value, Buffer &buffer) {
+	if constexpr (std::is_same_v<T, std::string_view>) {
+		JSONFormatTo(value, buffer);
+	} else {
+		FormatTo(value, buffer);
+	}
+}
+
+// The JSON encoding of a sequence of Fields, planned at compile time. Their
+// keys are escaped and joined with the separators and quotes in a constant
+// skeleton, so that only the values are encoded when logging, without
+// visiting any Value.
+template <typename... Fields> class JSONPlan {
+public:
+	inline static void Append(Buffer &buffer, const Fields &...fields) {
+		append(buffer, std::index_sequence_for<Fields...>{}, fields...);
+	}
+
+private:
+	constexpr static auto s_skeleton = planJSON<Fields...>();
+
+	template <size_t I>
+	inline constexpr static std::string_view fragment() noexcept {
+		constexpr size_t begin = I == 0 ? 0 : s_skeleton.ends[I - 1];
+		return std::string_view{
+		    s_skeleton.data.data() + begin,
+		    s_skeleton.ends[I] - begin,
+		};
+	}
+
+	template <size_t... I>
+	inline static void append(
+	    Buffer &buffer, std::index_sequence<I...>, const Fields &...fields
+	) {
+		((buffer += fragment<I>(), fieldToJSON(fields.value, buffer)), ...);
+		buffer += fragment<sizeof...(Fields)>();
+	}
+};
+
+} // namespace details
+
+inline void RecordToJSON(const Record &record, std::string &buffer) {
+	details::openJSON(record, buffer);
+	buffer += "}";
+}
+
+template <typename... Fields>
+    requires(details::FieldAttribute<Fields> && ...)
+inline void JSONFormatter::operator()(
+    const Record &record, Buffer &buffer, const Fields &...fields
+) const {
+	details::openJSON(record, buffer);
+	details::JSONPlan<Fields...>::Append(buffer, fields...);
 	buffer += "}";
 }
 
@@ -547,9 +759,17 @@ inline void RecordToRawText(const Record &record, Buffer &buffer) {
 
 	buffer += " " + details::levelName(record.level) + " ";
 
-	details::TextFormatTo(record.message, buffer);
+	details::TextFormatTo(details::viewOf(record.message), buffer);
 
-	for (const Attribute &attribute : record.attributes) {
+	details::appendContext(
+	    record,
+	    details::Context::Format::Text,
+	    buffer,
+	    [](const Attribute &attribute, Buffer &buffer) {
+		    details::attributeToText(attribute, "", buffer);
+	    }
+	);
+	for (const auto &attribute : record.attributes) {
 		details::attributeToText(attribute, "", buffer);
 	}
 }
@@ -559,13 +779,14 @@ inline void RecordToANSIText(const Record &record, Buffer &buffer) {
 
 	buffer += " " + details::levelColor(record.level) +
 	          details::levelName(record.level) + "\033[m ";
-	details::TextFormatTo(record.message, buffer);
+	details::TextFormatTo(details::viewOf(record.message), buffer);
 
-	size_t idx = 0;
-	for (const Attribute &attribute : record.attributes) {
-		bool isLast = ++idx == record.attributes.size();
+	const size_t count = record.AttributeCount();
+	size_t       idx   = 0;
+	record.ForEachAttribute([count, &idx, &buffer](const Attribute &attribute) {
+		bool isLast = ++idx == count;
 		details::attributeToTree(attribute, "\n", isLast, buffer);
-	}
+	});
 }
 
 }; // namespace slog
@@ -149,6 +149,62 @@ TEST(Formatters, JSON) {
 	}
 }
 
+TEST(Formatters, JSONPlan) {
+	TimeT ts{};
+	ts += std::chrono::hours(24);
+	const details::Record<0> record{ts, Level::Info, "planned"};
+
+	// the same attributes as in JSON/WithFields, with literal keys.
+	std::string buffer;
+	JSONFormatter{}(
+	    record,
+	    buffer,
+	    Int<"anInt">(1),
+	    Float<"aDouble">(1.5),
+	    StringView<"aString">("hello world"),
+	    Duration<"aDuration">(std::chrono::microseconds(32)),
+	    Time<"aTimestamp">(TimeT{}),
+	    Bool<"aBool">(true)
+	);
+	EXPECT_EQ(
+	    buffer,
+	    R"--({"time":"1970-01-02T00:00:00.000Z","level":"INFO","message":"planned","anInt":1,"aDouble":1.5,"aString":"hello world","aDuration":"32µs","aTimestamp":"1970-01-01T00:00:00.000Z","aBool":true})--"
+	);
+
+	// keys are escaped at compile time.
+	buffer.clear();
+	JSONFormatter{}(record, buffer, StringView<"a\"b\n">("c\td"));
+	EXPECT_EQ(
+	    buffer,
+	    R"--({"time":"1970-01-02T00:00:00.000Z","level":"INFO","message":"planned","a\"b\n":"c\td"})--"
+	);
+}
+
+TEST(Formatters, JSONKeysEscapedAlike) {
+	TimeT ts{};
+	ts += std::chrono::hours(24);
+
+	// the same key through the plan of JSONFormatter and RecordToJSON.
+	const details::Record<0> planned{ts, Level::Info, "escaped"};
+	std::string              plannedBuffer;
+	JSONFormatter{}(planned, plannedBuffer, Int<"a\"b\\c\n\x01">(1));
+
+	const details::Record<1> record{
+	    ts,
+	    Level::Info,
+	    "escaped",
+	    Int("a\"b\\c\n\x01", 1)
+	};
+	std::string buffer;
+	RecordToJSON(record, buffer);
+
+	EXPECT_EQ(buffer, plannedBuffer);
+	EXPECT_EQ(
+	    buffer,
+	    R"--({"time":"1970-01-02T00:00:00.000Z","level":"INFO","message":"escaped","a\"b\\c\n\u0001":1})--"
+	);
+}
+
 TEST(Formatters, RawText) {
 	struct TestData {
 		std::string             Name;
@@ -24,4 +24,14 @@ template <
 inline const Level SubLevel = static_cast<Level>(static_cast<size_t>(L) + N);
 
 constexpr size_t NumLevels = size_t(Level::Fatal) + 2;
+
+// The records below MinLevel are removed at compile time, with the code that
+// builds their attributes when logged with the SLOG_* macros. It is set by
+// defining SLOGPP_MIN_LEVEL to a level name, e.g. -DSLOGPP_MIN_LEVEL=Info, and
+// may differ between translation units.
+#ifdef SLOGPP_MIN_LEVEL
+constexpr Level MinLevel = Level::SLOGPP_MIN_LEVEL;
+#else
+constexpr Level MinLevel = Level::Unknown;
+#endif
 } // namespace slog
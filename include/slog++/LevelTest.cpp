@@ -0,0 +1,55 @@
+// removes the records below Info from this translation unit only.
+#define SLOGPP_MIN_LEVEL Info
+
+#include "LoggerTest.hpp"
+#include "gmock/gmock.h"
+
+#include "Logger.hpp"
+#include "MatcherTest.hpp"
+
+namespace slog {
+
+using ::testing::_;
+using ::testing::AllOf;
+using ::testing::InSequence;
+using ::testing::Return;
+
+static_assert(MinLevel == Level::Info);
+
+TEST_F(LoggerTest, MinLevelRemovesCalls) {
+	int  evaluated = 0;
+	auto status    = [&evaluated]() {
+		++evaluated;
+		return Int("status", 200);
+	};
+
+	// the removed calls never reach the sink.
+	EXPECT_CALL(*sink, Enabled(Level::Debug)).Times(0);
+	EXPECT_CALL(*sink, Enabled(Level::Trace)).Times(0);
+	{
+		InSequence seq;
+		EXPECT_CALL(*sink, Enabled(Level::Info)).WillRepeatedly(Return(true));
+		EXPECT_CALL(*sink, AllocateOnStack()).WillOnce(Return(true));
+		EXPECT_CALL(
+		    *sink,
+		    Log(AllOf(
+		        HasLevel<const Record *>(Level::Info),
+		        HasMessage<const Record *>("kept"),
+		        HasAttributes<const Record *>(Int("status", 200))
+		    ))
+		);
+	}
+
+	logger->Trace("removed");
+	logger->Debug("removed", status());
+	logger->Log(Level::Debug, "removed");
+	logger->DDebug("removed");
+	SLOG_DEBUG(*logger, "removed", status());
+	SLOG_LOG(*logger, Level::Trace, "removed", status());
+	EXPECT_EQ(evaluated, 1);
+
+	SLOG_INFO(*logger, "kept", status());
+	EXPECT_EQ(evaluated, 2);
+}
+
+} // namespace slog
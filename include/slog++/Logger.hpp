@@ -2,9 +2,12 @@
 
 #include "Attribute.hpp"
 #include "Level.hpp"
+#include "details/Context.hpp"
+#include "details/SinkRegistry.hpp"
 
 #include <functional>
 #include <memory>
+#include <type_traits>
 
 namespace slog {
 class Sink;
@@ -16,64 +19,107 @@ static AbortFunction          s_abortFunction = std::abort;
 static inline void setAbortFunction(AbortFunction &&abort) {
 	s_abortFunction = std::move(abort);
 }
+
+// A formatter encoding Attributes through a plan computed at compile time, as
+// JSONFormatter does for Fields.
+template <typename F, typename... Attributes>
+concept FieldsFormatter =
+    sizeof...(Attributes) > 0 && (FieldAttribute<Attributes> && ...) &&
+    requires(
+        const F            &formatter,
+        const slog::Record &record,
+        Buffer             &buffer,
+        const std::decay_t<Attributes> &...fields
+    ) { formatter(record, buffer, fields...); };
+
+// Lets the SLOG_* macros, which already checked the level, log without
+// checking it again.
+struct MacroLogger;
 } // namespace details
 
-template <size_t N> class Logger {
+// A logger adding N attributes to its records, and writing them to a SinkT.
+//
+// By default, the sink is called through the virtual Sink interface. A logger
+// typed with a synchronous sink, such as FileSink<MTSafe>, calls it directly
+// instead, so that the level check, the record construction, the formatting
+// and the write can be inlined at the call site. Its records are formatted by
+// FormatterT, such as JSONFormatter, or by the sink formatter if void. When
+// all the attributes of a call are Fields, such as Int<"code">(code), and
+// FormatterT can plan them, they are encoded without converting them to
+// Attributes.
+template <size_t N, typename SinkT = Sink, typename FormatterT = void>
+class Logger {
 public:
-	template <size_t M> friend class Logger;
+	template <size_t M, typename S, typename F> friend class Logger;
+	friend struct details::MacroLogger;
 
-	Logger(std::shared_ptr<Sink> sink) noexcept;
+	Logger(std::shared_ptr<SinkT> sink) noexcept;
 
-	inline std::shared_ptr<Sink> SetSink(std::shared_ptr<Sink> sink) {
-		auto oldSink = std::move(d_sink);
-		d_sink       = std::move(sink);
-		return std::move(oldSink);
-	}
+	std::shared_ptr<SinkT> SetSink(std::shared_ptr<SinkT> sink);
 
 	void From(Level lvl) const noexcept;
 
 	void Set(Level lvl, bool enabled) const noexcept;
 
+	// Returns true if the records of level lvl are logged.
+	bool Enabled(Level lvl) const noexcept;
+
+	// Waits up to timeout for all the records logged before the call to be
+	// written and flushed. Returns false if the timeout expired.
+	bool Flush(DurationT timeout = DurationT::max()) const;
+
 	template <typename... Attributes>
-	Logger<N + sizeof...(Attributes)> With(Attributes &&...attributes
-	) const noexcept;
+	Logger<N + sizeof...(Attributes), SinkT, FormatterT>
+	With(Attributes &&...attributes) const noexcept;
 
-	template <typename Str, typename... Attributes>
+	// Min is the MinLevel of the calling translation unit, which may differ
+	// between translation units.
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	void Log(Level level, Str &&msg, Attributes &&...attributes) const;
 
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void Trace(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Trace,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Trace >= Min) {
+			Log(Level::Trace,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void Debug(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Debug,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Debug >= Min) {
+			Log(Level::Debug,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void Info(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Info,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Info >= Min) {
+			Log(Level::Info,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void Warn(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Warn,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Warn >= Min) {
+			Log(Level::Warn,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void Error(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Error,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Error >= Min) {
+			Log(Level::Error,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
 	template <typename Str, typename... Attributes>
@@ -81,42 +127,54 @@ public:
 		Log(Level::Fatal,
 		    std::forward<Str>(msg),
 		    std::forward<Attributes>(attributes)...);
+		// gives a chance to the async sinks to write the fatal record.
+		details::drainAsyncSinks(details::FatalDrainTimeout);
 		details::s_abortFunction();
 	};
 #ifndef NDEBUG
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void DTrace(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Trace,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Trace >= Min) {
+			Log(Level::Trace,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void DDebug(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Debug,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Debug >= Min) {
+			Log(Level::Debug,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void DInfo(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Info,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Info >= Min) {
+			Log(Level::Info,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void DWarn(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Warn,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Warn >= Min) {
+			Log(Level::Warn,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
-	template <typename Str, typename... Attributes>
+	template <typename Str, typename... Attributes, Level Min = MinLevel>
 	inline void DError(Str &&msg, Attributes &&...attributes) const {
-		Log(Level::Error,
-		    std::forward<Str>(msg),
-		    std::forward<Attributes>(attributes)...);
+		if constexpr (Level::Error >= Min) {
+			Log(Level::Error,
+			    std::forward<Str>(msg),
+			    std::forward<Attributes>(attributes)...);
+		}
 	};
 
 #else
@@ -153,10 +211,67 @@ public:
 #endif
 
 private:
-	std::shared_ptr<Sink>        d_sink;
-	details::Array<Attribute, N> d_attributes;
+	constexpr static bool Typed = std::is_same_v<SinkT, Sink> == false;
+
+	bool allocateOnStack() const noexcept;
+
+	// Logs a record whose level is known to be enabled.
+	template <typename Str, typename... Attributes>
+	void logEnabled(Level level, Str &&msg, Attributes &&...attributes) const;
+
+	std::shared_ptr<SinkT>    d_sink;
+	// the levels of d_sink, if it keeps them in a mask.
+	const details::LevelMask *d_levels;
+	// holds the N attributes added by With(), if any.
+	details::ContextPtr       d_context;
+};
+
+namespace details {
+struct MacroLogger {
+	template <typename L, typename Str, typename... Attributes>
+	inline static void
+	Log(const L &logger, Level level, Str &&msg, Attributes &&...attributes) {
+		logger.logEnabled(
+		    level,
+		    std::forward<Str>(msg),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 };
+} // namespace details
 
 } // namespace slog
 
+// Log with logger only if level is enabled. Unlike Logger<N>::Log(), the
+// message and the attributes are not evaluated when the level is disabled, so
+// that a disabled call costs a single level check. logger and level are
+// evaluated once.
+#define SLOG_LOG(logger, level, ...)                                           \
+	do {                                                                       \
+		const auto         &slogpp_logger = (logger);                          \
+		const ::slog::Level slogpp_level  = (level);                           \
+		if (slogpp_level >= ::slog::MinLevel &&                                \
+		    slogpp_logger.Enabled(slogpp_level)) {                             \
+			::slog::details::MacroLogger::Log(                                 \
+			    slogpp_logger,                                                 \
+			    slogpp_level,                                                  \
+			    __VA_ARGS__                                                    \
+			);                                                                 \
+		}                                                                      \
+	} while (0)
+
+// As SLOG_LOG(), but removed at compile time when name is below MinLevel.
+#define SLOGPP_LOG_AT(name, logger, ...)                                       \
+	do {                                                                       \
+		if constexpr (::slog::Level::name >= ::slog::MinLevel) {               \
+			SLOG_LOG(logger, ::slog::Level::name, __VA_ARGS__);                \
+		}                                                                      \
+	} while (0)
+
+#define SLOG_TRACE(logger, ...) SLOGPP_LOG_AT(Trace, logger, __VA_ARGS__)
+#define SLOG_DEBUG(logger, ...) SLOGPP_LOG_AT(Debug, logger, __VA_ARGS__)
+#define SLOG_INFO(logger, ...)  SLOGPP_LOG_AT(Info, logger, __VA_ARGS__)
+#define SLOG_WARN(logger, ...)  SLOGPP_LOG_AT(Warn, logger, __VA_ARGS__)
+#define SLOG_ERROR(logger, ...) SLOGPP_LOG_AT(Error, logger, __VA_ARGS__)
+
 #include "LoggerImpl.hpp"
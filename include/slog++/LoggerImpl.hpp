@@ -11,100 +11,160 @@
 
 namespace slog {
 
-template <size_t N> inline void Logger<N>::From(Level lvl) const noexcept {
+template <size_t N, typename SinkT, typename FormatterT>
+inline void Logger<N, SinkT, FormatterT>::From(Level lvl) const noexcept {
 	d_sink->From(lvl);
 }
 
-template <size_t N>
-inline void Logger<N>::Set(Level lvl, bool enabled) const noexcept {
+template <size_t N, typename SinkT, typename FormatterT>
+inline void
+Logger<N, SinkT, FormatterT>::Set(Level lvl, bool enabled) const noexcept {
 	d_sink->Set(lvl, enabled);
 }
 
-template <size_t N>
-inline Logger<N>::Logger(std::shared_ptr<Sink> sink) noexcept
-    : d_sink{std::move(sink)} {};
+template <size_t N, typename SinkT, typename FormatterT>
+inline bool Logger<N, SinkT, FormatterT>::Enabled(Level lvl) const noexcept {
+	// a single relaxed load for the sinks keeping a mask.
+	if (d_levels != nullptr) {
+		return d_levels->Enabled(lvl);
+	}
+	return d_sink && d_sink->Enabled(lvl);
+}
+
+template <size_t N, typename SinkT, typename FormatterT>
+inline bool Logger<N, SinkT, FormatterT>::Flush(DurationT timeout) const {
+	if (!d_sink) {
+		return true;
+	}
+	auto done = d_sink->Flush();
+	if (timeout == DurationT::max()) {
+		done.wait();
+		return true;
+	}
+	return done.wait_for(timeout) == std::future_status::ready;
+}
+
+template <size_t N, typename SinkT, typename FormatterT>
+inline Logger<N, SinkT, FormatterT>::Logger(std::shared_ptr<SinkT> sink
+) noexcept
+    : d_sink{std::move(sink)}
+    , d_levels{d_sink ? d_sink->EnabledLevels() : nullptr} {};
+
+template <size_t N, typename SinkT, typename FormatterT>
+inline std::shared_ptr<SinkT>
+Logger<N, SinkT, FormatterT>::SetSink(std::shared_ptr<SinkT> sink) {
+	auto oldSink = std::move(d_sink);
+	d_sink       = std::move(sink);
+	d_levels     = d_sink ? d_sink->EnabledLevels() : nullptr;
+	return oldSink;
+}
 
-template <size_t N>
+template <size_t N, typename SinkT, typename FormatterT>
 template <typename... Attributes>
-inline Logger<N + sizeof...(Attributes)>
-Logger<N>::With(Attributes &&...attributes) const noexcept {
-	Logger<N + sizeof...(Attributes)> result{d_sink};
-	std::copy(
-	    d_attributes.begin(),
-	    d_attributes.end(),
-	    result.d_attributes.begin()
+inline Logger<N + sizeof...(Attributes), SinkT, FormatterT>
+Logger<N, SinkT, FormatterT>::With(Attributes &&...attributes) const noexcept {
+	Logger<N + sizeof...(Attributes), SinkT, FormatterT> result{d_sink};
+	// only the new attributes are copied, the parent ones are shared.
+	result.d_context = std::make_shared<
+	    const details::ContextBlock<sizeof...(Attributes)>>(
+	    d_context,
+	    N,
+	    std::forward<Attributes>(attributes)...
 	);
-	std::size_t index = N - 1;
-	((result.d_attributes[++index] = std::forward<Attributes>(attributes)),
-	 ...);
 
 	return result;
 }
 
-template <size_t N>
-template <typename Str, typename... Attributes>
-inline void
-Logger<N>::Log(Level level, Str &&msg, Attributes &&...attributes) const {
+template <size_t N, typename SinkT, typename FormatterT>
+template <typename Str, typename... Attributes, Level Min>
+inline void Logger<N, SinkT, FormatterT>::Log(
+    Level level, Str &&msg, Attributes &&...attributes
+) const {
 	// early discard the entry
-	if (!d_sink || !d_sink->Enabled(level)) {
+	if (level < Min || !Enabled(level)) {
 		return;
 	}
-
-	constexpr size_t RecordSize = N + sizeof...(Attributes);
-
-	if (d_sink->AllocateOnStack() == true) {
-
-		// build the record.
-		details::Record<RecordSize> record(
-		    level,
-		    std::forward<Str>(msg),
-		    d_attributes,
-		    std::forward<Attributes>(attributes)...
-		);
-
-		d_sink->Log(&record);
-		return;
-	}
-	using Ptr = std::unique_ptr<const Record>;
-	d_sink->Log(
-	    std::forward<Ptr>(std::make_unique<const details::Record<RecordSize>>(
-	        level,
-	        std::forward<Str>(msg),
-	        d_attributes,
-	        std::forward<Attributes>(attributes)...
-	    ))
+	logEnabled(
+	    level,
+	    std::forward<Str>(msg),
+	    std::forward<Attributes>(attributes)...
 	);
 }
 
-template <>
+template <size_t N, typename SinkT, typename FormatterT>
 template <typename Str, typename... Attributes>
-inline void
-Logger<0>::Log(Level level, Str &&msg, Attributes &&...attributes) const {
-	// early discard the entry
-	if (!d_sink || !d_sink->Enabled(level)) {
+inline void Logger<N, SinkT, FormatterT>::logEnabled(
+    Level level, Str &&msg, Attributes &&...attributes
+) const {
+	// the attributes of the context are not copied in the record.
+	constexpr size_t RecordSize = sizeof...(Attributes);
+
+	if constexpr (details::FieldsFormatter<FormatterT, Attributes...>) {
+		// the record only references the context, the fields are encoded by
+		// the plan of the formatter.
+		details::Record<0> record(level, std::forward<Str>(msg));
+		record.context = details::ContextPtr{
+		    details::ContextPtr{},
+		    d_context.get(),
+		};
+		d_sink->LogRecord(
+		    record,
+		    [&attributes...](const Record &r, Buffer &buffer) {
+			    FormatterT{}(r, buffer, attributes...);
+		    }
+		);
 		return;
 	}
 
-	constexpr size_t RecordSize = sizeof...(Attributes);
-	if (d_sink->AllocateOnStack() == true) {
+	if (allocateOnStack()) {
 
+		// build the record, borrowing the groups and string views as it does
+		// not outlive them.
 		details::Record<RecordSize> record(
+		    level,
+		    std::forward<Str>(msg),
+		    details::borrow(std::forward<Attributes>(attributes))...
+		);
+		record.context = details::ContextPtr{
+		    details::ContextPtr{},
+		    d_context.get(),
+		};
+
+		if constexpr (std::is_void_v<FormatterT> == false) {
+			d_sink->LogRecord(record, FormatterT{});
+		} else if constexpr (Typed) {
+			d_sink->LogRecord(record);
+		} else {
+			d_sink->Log(&record);
+		}
+		return;
+	}
+	if constexpr (Typed == false) {
+		auto record = std::make_unique<details::Record<RecordSize>>(
 		    level,
 		    std::forward<Str>(msg),
 		    std::forward<Attributes>(attributes)...
 		);
+		record->context = d_context;
+		d_sink->Log(std::unique_ptr<const Record>{std::move(record)});
+	}
+}
 
-		d_sink->Log(&record);
-		return;
+template <size_t N, typename SinkT, typename FormatterT>
+inline bool Logger<N, SinkT, FormatterT>::allocateOnStack() const noexcept {
+	if constexpr (Typed) {
+		static_assert(
+		    SinkT::Synchronous,
+		    "a typed logger writes its records on the logging thread"
+		);
+		return true;
+	} else {
+		static_assert(
+		    std::is_void_v<FormatterT>,
+		    "a logger with a formatter must be typed with its sink"
+		);
+		return d_sink->AllocateOnStack();
 	}
-	using Ptr = std::unique_ptr<const Record>;
-	d_sink->Log(
-	    std::forward<Ptr>(std::make_unique<const details::Record<RecordSize>>(
-	        level,
-	        std::forward<Str>(msg),
-	        std::forward<Attributes>(attributes)...
-	    ))
-	);
 }
 
 } // namespace slog
@@ -1,6 +1,8 @@
 #include "LoggerTest.hpp"
+#include "AllocationCounterTest.hpp"
 #include "gmock/gmock.h"
 
+#include "Formatters.hpp"
 #include "Logger.hpp"
 #include "MatcherTest.hpp"
 
@@ -87,6 +89,35 @@ TEST_F(LoggerTest, LogEarlyDisabled) {
 	logger->Log(Level::Info, "never logged");
 }
 
+TEST_F(LoggerTest, MacroEvaluatesLazily) {
+	int  evaluated = 0;
+	auto status    = [&evaluated]() {
+		++evaluated;
+		return Int("status", 200);
+	};
+
+	{
+		InSequence seq;
+		EXPECT_CALL(*sink, Enabled(Level::Debug)).WillOnce(Return(false));
+		// the level is only checked once.
+		EXPECT_CALL(*sink, Enabled(Level::Info)).WillOnce(Return(true));
+		EXPECT_CALL(*sink, AllocateOnStack()).WillOnce(Return(true));
+		EXPECT_CALL(
+		    *sink,
+		    Log(AllOf(
+		        HasLevel<const Record *>(Level::Info),
+		        HasMessage<const Record *>("with attribute"),
+		        HasAttributes<const Record *>(Int("status", 200))
+		    ))
+		);
+	}
+
+	SLOG_DEBUG(*logger, "never logged", status());
+	EXPECT_EQ(evaluated, 0);
+	SLOG_INFO(*logger, "with attribute", status());
+	EXPECT_EQ(evaluated, 1);
+}
+
 TEST_F(LoggerTest, AttributeLogging) {
 
 	{
@@ -106,6 +137,28 @@ TEST_F(LoggerTest, AttributeLogging) {
 	logger->Info("with attribute", Int("status", 200));
 }
 
+TEST_F(LoggerTest, FieldLogging) {
+	// an untyped logger converts the fields to attributes.
+	const std::string url = "https://example.com";
+	{
+		InSequence seq;
+		EXPECT_CALL(*sink, Enabled(Level::Info)).WillOnce(Return(true));
+		EXPECT_CALL(*sink, AllocateOnStack()).WillOnce(Return(false));
+		EXPECT_CALL(
+		    *sink,
+		    Log(AllOf(
+		        HasLevel<std::unique_ptr<const Record>>(Level::Info),
+		        HasAttributes<std::unique_ptr<const Record>>(
+		            Int("status", 200),
+		            String("url", url)
+		        )
+		    ))
+		);
+	}
+
+	logger->Info("with fields", Int<"status">(200), StringView<"url">(url));
+}
+
 TEST_F(LoggerTest, AttributePropagation) {
 
 	auto derived = logger->With(String("request", "https://example.com"));
@@ -129,4 +182,184 @@ TEST_F(LoggerTest, AttributePropagation) {
 	derived.Warn("unknown resource", Int("status", 404));
 }
 
+TEST_F(LoggerTest, GroupLogging) {
+	// groups are borrowed by records on the stack, and owned otherwise.
+	ExpectLoggedOnStackAndHeap(
+	    *sink,
+	    Level::Info,
+	    [this]() {
+		    logger->Info(
+		        "with group",
+		        Group(
+		            "request",
+		            String("url", "https://example.com"),
+		            Int("status", 200)
+		        )
+		    );
+	    },
+	    [](const Record &r, bool) {
+		    ASSERT_EQ(r.attributes.size(), 1);
+		    EXPECT_EQ(r.attributes[0].key, "request");
+		    const auto &group = get<GroupPtr>(r.attributes[0].value);
+		    ASSERT_NE(group, nullptr);
+		    ASSERT_EQ(group->attributes.size(), 2);
+		    EXPECT_EQ(group->attributes[1], Int("status", 200));
+	    }
+	);
+}
+
+TEST_F(LoggerTest, StringViewLogging) {
+	// string views are borrowed by records on the stack, and copied otherwise.
+	const std::string body(4096, 'b');
+	ExpectLoggedOnStackAndHeap(
+	    *sink,
+	    Level::Info,
+	    [this, &body]() {
+		    logger->Info("with body", StringView("body", body));
+	    },
+	    [&body](const Record &r, bool onStack) {
+		    ASSERT_EQ(r.attributes.size(), 1);
+		    const auto &value = r.attributes[0].value;
+		    if (onStack) {
+			    ASSERT_TRUE(holds_alternative<details::StringRef>(value));
+			    const auto &ref = get<details::StringRef>(value);
+			    EXPECT_EQ(ref.view.data(), body.data());
+		    } else {
+			    ASSERT_TRUE(holds_alternative<StringType>(value));
+			    EXPECT_EQ(details::viewOf(get<StringType>(value)), body);
+		    }
+	    }
+	);
+}
+
+TEST_F(LoggerTest, ContextLogging) {
+	// the context is borrowed by records on the stack, and shared otherwise,
+	// but never copied in their attributes.
+	auto derived = logger->With(String("request", "https://example.com"));
+	ExpectLoggedOnStackAndHeap(
+	    *sink,
+	    Level::Info,
+	    [&derived]() { derived.Info("with context", Int("status", 200)); },
+	    [](const Record &r, bool onStack) {
+		    ASSERT_EQ(r.attributes.size(), 1);
+		    EXPECT_EQ(r.attributes[0], Int("status", 200));
+		    ASSERT_NE(r.context, nullptr);
+		    EXPECT_EQ(r.context->Size(), 1);
+		    EXPECT_EQ(r.AttributeCount(), 2);
+		    EXPECT_EQ(r.context.use_count(), onStack ? 0 : 2);
+
+		    Buffer json, text;
+		    RecordToJSON(r, json);
+		    RecordToRawText(r, text);
+		    EXPECT_THAT(
+		        json,
+		        ::testing::EndsWith(
+		            ",\"request\":\"https://example.com\",\"status\":200}"
+		        )
+		    );
+		    EXPECT_THAT(
+		        text,
+		        ::testing::EndsWith(" request=https://example.com status=200")
+		    );
+	    }
+	);
+}
+
+TEST_F(LoggerTest, ContextChaining) {
+	// a derived logger shares the attributes of its parent.
+	auto request = logger->With(
+	    Group("request", String("url", "https://example.com"))
+	);
+	auto tenant = request.With(Int("tenant", 7));
+
+	InSequence seq;
+	EXPECT_CALL(*sink, Enabled(Level::Info)).WillOnce(Return(true));
+	EXPECT_CALL(*sink, AllocateOnStack()).WillOnce(Return(true));
+	EXPECT_CALL(*sink, Log(_)).WillOnce([](Sink::RecordVariant &&record) {
+		const auto *r = std::get<const Record *>(record);
+		ASSERT_EQ(r->attributes.size(), 1);
+		EXPECT_EQ(r->attributes[0], Int("status", 200));
+		EXPECT_EQ(r->context->Size(), 2);
+		const auto attributes = AllAttributes(*r);
+		ASSERT_EQ(attributes.size(), 3);
+		// only held by the context block of request, and by attributes.
+		EXPECT_EQ(get<GroupPtr>(attributes[0].value).use_count(), 2);
+		EXPECT_EQ(attributes[1], Int("tenant", 7));
+		EXPECT_EQ(attributes[2], Int("status", 200));
+
+		Buffer json;
+		RecordToJSON(*r, json);
+		EXPECT_THAT(
+		    json,
+		    ::testing::EndsWith(",\"request\":{\"url\":\"https://example.com\"}"
+		                        ",\"tenant\":7,\"status\":200}")
+		);
+	});
+	tenant.Info("with context", Int("status", 200));
+
+	EXPECT_CALL(*sink, Enabled(Level::Info)).WillOnce(Return(true));
+	EXPECT_CALL(*sink, AllocateOnStack()).WillOnce(Return(true));
+	EXPECT_CALL(*sink, Log(_)).WillOnce([](Sink::RecordVariant &&record) {
+		const auto *r = std::get<const Record *>(record);
+		const auto attributes = AllAttributes(*r);
+		ASSERT_EQ(attributes.size(), 2);
+		EXPECT_EQ(attributes[0].key, "request");
+		EXPECT_EQ(attributes[1], Int("status", 404));
+	});
+	request.Info("unknown resource", Int("status", 404));
+}
+
+TEST_F(LoggerTest, Flush) {
+	std::shared_ptr<FlushBarrier> held;
+	EXPECT_CALL(*sink, Flush(_))
+	    .WillOnce([&held](std::shared_ptr<FlushBarrier> barrier) {
+		    held = std::move(barrier);
+	    })
+	    .WillOnce(Return());
+
+	EXPECT_FALSE(logger->Flush(std::chrono::milliseconds(1)));
+	held.reset();
+	EXPECT_TRUE(logger->Flush());
+}
+
+// A user-defined sink, written before Flush() was added to Sink.
+class UnbufferedSink : public Sink {
+public:
+	bool AllocateOnStack() const noexcept override {
+		return true;
+	}
+
+	bool Enabled(Level) const noexcept override {
+		return true;
+	}
+
+	void From(Level) noexcept override {}
+
+	void Set(Level, bool) noexcept override {}
+
+	void Log(RecordVariant &&) override {}
+};
+
+TEST(UnbufferedSinkTest, FlushesOnReturn) {
+	Logger<0> logger(std::make_shared<UnbufferedSink>());
+	EXPECT_TRUE(logger.Flush(DurationT::zero()));
+}
+
+TEST(UnbufferedSinkTest, GroupsDoNotAllocate) {
+	Logger<0> logger(std::make_shared<UnbufferedSink>());
+	const auto log = [&logger]() {
+		logger.Info(
+		    "with group",
+		    Group("request", Int("status", 200), Bool("cached", true))
+		);
+	};
+	// the first group allocates the block reused by the next ones.
+	log();
+	const auto allocations = ThreadAllocations();
+	for (int i = 0; i < 3; ++i) {
+		log();
+	}
+	EXPECT_EQ(ThreadAllocations(), allocations);
+}
+
 } // namespace slog
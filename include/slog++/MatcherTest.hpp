@@ -5,13 +5,17 @@
 #include "gmock/gmock.h"
 #include <gmock/gmock.h>
 
+#include "MockSink.hpp"
 #include "Record.hpp"
 
+#include <vector>
+
 namespace slog {
 using ::testing::ElementsAreArray;
 using ::testing::Eq;
 using ::testing::Field;
 using ::testing::Pointee;
+using ::testing::ResultOf;
 using ::testing::StrEq;
 using ::testing::VariantWith;
 
@@ -35,14 +39,49 @@ inline constexpr auto HasMessage = [](const auto &message) {
 #endif
 };
 
+// Returns the attributes of record, including those of its context.
+inline std::vector<Attribute> AllAttributes(const Record &record) {
+	std::vector<Attribute> result;
+	record.ForEachAttribute([&result](const Attribute &attribute) {
+		result.push_back(attribute);
+	});
+	return result;
+}
+
 template <typename T, typename... Attributes>
 auto HasAttributes(Attributes &&...attributes) {
 	std::initializer_list<Attribute> attrs = {
 	    static_cast<Attribute>(attributes)...,
 	};
 	return VariantWith<T>(Pointee(
-	    Field("attributes", &Record::attributes, ElementsAreArray(attrs))
+	    ResultOf("attributes", &AllAttributes, ElementsAreArray(attrs))
 	));
 }
 
+// Expects sink to be given one record at level, once allocated on the stack
+// and once on the heap, by calling log(), and checks it with
+// check(record, onStack).
+template <typename Log, typename Check>
+inline void ExpectLoggedOnStackAndHeap(
+    MockSink &sink, Level level, const Log &log, const Check &check
+) {
+	using ::testing::_;
+	using ::testing::Return;
+	for (bool onStack : {true, false}) {
+		SCOPED_TRACE(onStack ? "on stack" : "on heap");
+		::testing::InSequence seq;
+		EXPECT_CALL(sink, Enabled(level)).WillOnce(Return(true));
+		EXPECT_CALL(sink, AllocateOnStack()).WillOnce(Return(onStack));
+		EXPECT_CALL(sink, Log(_))
+		    .WillOnce([onStack, &check](Sink::RecordVariant &&record) {
+			    const auto *r = std::visit(
+			        [](const auto &r) -> const Record * { return &*r; },
+			        record
+			    );
+			    check(*r, onStack);
+		    });
+		log();
+	}
+}
+
 } // namespace slog
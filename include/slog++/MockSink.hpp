@@ -13,6 +13,9 @@ public:
 	MOCK_METHOD(void, From, (Level lvl), (noexcept, override));
 	MOCK_METHOD(void, Set, (Level lvl, bool enabled), (noexcept, override));
 	MOCK_METHOD(void, Log, (Sink::RecordVariant &&), (override));
+	MOCK_METHOD(void, Flush, (std::shared_ptr<FlushBarrier>), (override));
+
+	using Sink::Flush;
 };
 
 } // namespace slog
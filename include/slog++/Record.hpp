@@ -3,6 +3,8 @@
 #include "Attribute.hpp"
 #include "Level.hpp"
 #include "Types.hpp"
+#include "details/Context.hpp"
+#include "details/RecordArena.hpp"
 
 namespace slog {
 
@@ -11,9 +13,22 @@ public:
 	TimeT                                timestamp;
 	Level                                level;
 	StringType                           message;
+	// The attributes of the log call, following those of context.
 	utils::ContainerReference<Attribute> attributes;
+	// The context of the logger, if derived with With(). It holds the leading
+	// attributes, which are not copied in attributes, and is not owned by the
+	// records built on the stack.
+	details::ContextPtr                  context;
 	virtual ~Record() = default;
 
+	// Calls f on each attribute of the record: those of its context, then
+	// its own ones.
+	template <typename F> void ForEachAttribute(F &&f) const;
+
+	// Returns the number of attributes of the record, including those of its
+	// context.
+	size_t AttributeCount() const noexcept;
+
 	// non-copyable non-movable;
 	Record(const Record &)            = delete;
 	Record(Record &&)                 = delete;
@@ -31,19 +46,8 @@ namespace details {
 template <size_t N> class Record : public slog::Record {
 public:
 	/**
-	 * Constructor from a mix of copied and perfect forwarded Attributes, to in
-	 * Logger<N> with N > 0.
-	 */
-	template <typename Str, size_t M, typename... Attributes>
-	Record(
-	    Level                      level,
-	    Str                      &&message,
-	    const Array<Attribute, M> &copiedAttributes,
-	    Attributes &&...attributes
-	) noexcept;
-
-	/**
-	 * Constructor for only forwarded attributes. Used by Logger<0>.
+	 * Constructor for only forwarded attributes. Used by Logger<N>, which
+	 * sets the context of the record.
 	 */
 	template <typename Str, typename... Attributes>
 	Record(Level level, Str &&message, Attributes &&...attributes) noexcept;
@@ -59,6 +63,18 @@ public:
 	    Attributes &&...attributes
 	) noexcept;
 
+	// Records logged to asynchronous sinks are allocated from RecordArena,
+	// which replaces per size class pools of Record<N>: the records of any
+	// size share the chunks of their thread, recycled once all their records
+	// are destroyed.
+	inline static void *operator new(size_t size) {
+		return RecordArena::Allocate(size);
+	}
+
+	inline static void operator delete(void *ptr) noexcept {
+		RecordArena::Deallocate(ptr);
+	}
+
 private:
 	details::Array<Attribute, N> d_data;
 };
@@ -66,7 +82,7 @@ private:
 template <> class Record<0> : public slog::Record {
 public:
 	/**
-	 * Constructor for only forwarded attributes. Used by Logger<0>.
+	 * Constructor without attributes. Used by Logger<N>.
 	 */
 	template <typename Str> Record(Level level, Str &&message) noexcept;
 
@@ -75,6 +91,15 @@ public:
 	 */
 	template <typename Timestamp, typename Str>
 	Record(Timestamp &&timestamp, Level level, Str &&message) noexcept;
+
+	// as Record<N>.
+	inline static void *operator new(size_t size) {
+		return RecordArena::Allocate(size);
+	}
+
+	inline static void operator delete(void *ptr) noexcept {
+		RecordArena::Deallocate(ptr);
+	}
 };
 
 } // namespace details
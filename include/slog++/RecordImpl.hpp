@@ -20,38 +20,21 @@ inline Record::Record(Timestamp &&time, Level level, Str &&message) noexcept
     , level{level}
     , message{std::forward<Str>(message)} {}
 
-namespace details {
-
-template <
-    typename T,
-    size_t N,
-    typename... U,
-    std::enable_if_t<(N + sizeof...(U)) >= 1> * = nullptr>
-Array<T, N + sizeof...(U)> append(const Array<T, N> &a, U &&...values) {
-	Array<T, N + sizeof...(U)> result{};
-	std::copy(a.begin(), a.end(), result.begin());
-	std::size_t index = N - 1;
-	((result[++index] = std::forward<U>(values)), ...);
-	return result;
+template <typename F> inline void Record::ForEachAttribute(F &&f) const {
+	if (context) {
+		context->ForEach(f);
+	}
+	for (const auto &attribute : attributes) {
+		f(attribute);
+	}
 }
 
-template <size_t N>
-template <typename Str, size_t M, typename... Attributes>
-inline Record<N>::Record(
-    Level                      level,
-    Str                      &&message,
-    const Array<Attribute, M> &copiedAttributes,
-    Attributes &&...attributes
-) noexcept
-    : slog::Record{level, std::forward<Str>(message)}
-    , d_data{
-          details::append(
-              copiedAttributes, std::forward<Attributes>(attributes)...
-          ),
-      } {
-	this->attributes = utils::ContainerReference<Attribute>{d_data};
+inline size_t Record::AttributeCount() const noexcept {
+	return (context ? context->Size() : 0) + attributes.size();
 }
 
+namespace details {
+
 template <size_t N>
 template <typename Str, typename... Attributes>
 inline Record<N>::Record(
@@ -72,7 +55,7 @@ inline Record<N>::Record(
 ) noexcept
     : slog::
           Record{std::forward<Timestamp>(timestamp), level, std::forward<Str>(message)}
-    , d_data{std::forward<Attribute>(attributes)...} {
+    , d_data{std::forward<Attributes>(attributes)...} {
 	this->attributes = utils::ContainerReference<Attribute>(d_data);
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Level.hpp"
+#include "details/LevelMask.hpp"
 
+#include <future>
 #include <memory>
 #include <variant>
 
@@ -9,6 +11,30 @@ namespace slog {
 class Record;
 class BaseSinkConfig;
 
+// Completes a flush request once every sink holding it released it. Sinks keep
+// a reference until the records logged before the request are written and
+// flushed.
+class FlushBarrier {
+public:
+	inline FlushBarrier() = default;
+
+	inline ~FlushBarrier() {
+		d_done.set_value();
+	}
+
+	FlushBarrier(const FlushBarrier &)            = delete;
+	FlushBarrier(FlushBarrier &&)                 = delete;
+	FlushBarrier &operator=(const FlushBarrier &) = delete;
+	FlushBarrier &operator=(FlushBarrier &&)      = delete;
+
+	inline std::future<void> Future() {
+		return d_done.get_future();
+	}
+
+private:
+	std::promise<void> d_done;
+};
+
 class Sink {
 public:
 	using RecordVariant = std::variant<
@@ -22,11 +48,31 @@ public:
 
 	virtual bool Enabled(Level lvl) const noexcept = 0;
 
+	// Returns the enabled levels, if the sink keeps them in a mask living as
+	// long as the sink. Loggers then test them without calling Enabled().
+	virtual const details::LevelMask *EnabledLevels() const noexcept {
+		return nullptr;
+	}
+
 	virtual void From(Level lvl) noexcept = 0;
 
 	virtual void Set(Level lvl, bool enabled) noexcept = 0;
 
 	virtual void Log(RecordVariant &&record) = 0;
+
+	// Holds barrier until all the records logged before the call are written
+	// and flushed. Sinks writing their records on Log() without buffering them
+	// have nothing to wait for, and release it on return.
+	virtual void Flush(std::shared_ptr<FlushBarrier>) {}
+
+	// Returns a future ready once all the records logged before the call are
+	// written and flushed.
+	inline std::future<void> Flush() {
+		auto barrier = std::make_shared<FlushBarrier>();
+		auto res     = barrier->Future();
+		Flush(std::move(barrier));
+		return res;
+	}
 };
 
 }; // namespace slog
@@ -1,15 +1,29 @@
 #pragma once
 
+#include "Config.hpp"
 #include "Formatters.hpp"
 #include "Level.hpp"
+#include "Record.hpp"
 #include "Sink.hpp"
+#include "details/EncodedRecord.hpp"
+#include "details/SinkRegistry.hpp"
+#include "utils/AsymmetricBarrier.hpp"
 #include "utils/ObjectPool.hpp"
+#include "utils/PerThreadQueue.hpp"
+#include "utils/RingBuffer.hpp"
 #include "utils/ThreadPool.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
 #include <future>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 namespace slog {
 
@@ -25,53 +39,133 @@ enum ConcurencyMode {
 	AsyncMtSafe = 3,
 };
 
+// The buffer in which the calling thread formats the records of synchronous
+// sinks, keeping the capacity of the previous ones. Unlike bufferPool, it
+// remains usable by loggers called during the static destruction: once the
+// thread's buffer is destroyed, or while an enclosing log call of the same
+// thread uses it, a local buffer is used instead.
+class ThreadBuffer {
+public:
+	inline ThreadBuffer()
+	    : d_cached{acquire()} {}
+
+	inline ~ThreadBuffer() {
+		if (d_cached != nullptr) {
+			d_cached->inUse = false;
+		}
+	}
+
+	// ThreadBuffer is non-movable non-copyable
+	ThreadBuffer(const ThreadBuffer &)            = delete;
+	ThreadBuffer(ThreadBuffer &&)                 = delete;
+	ThreadBuffer &operator=(const ThreadBuffer &) = delete;
+	ThreadBuffer &operator=(ThreadBuffer &&)      = delete;
+
+	inline Buffer &operator*() noexcept {
+		return d_cached != nullptr ? d_cached->buffer : d_local;
+	}
+
+private:
+	struct Cached {
+		Buffer buffer;
+		bool   inUse = false;
+		bool  &destroyed;
+
+		inline ~Cached() {
+			destroyed = true;
+		}
+	};
+
+	// Returns the cleared buffer of the thread, or nullptr if it is destroyed
+	// or in use.
+	inline static Cached *acquire() noexcept {
+		// trivially destructible, it remains valid after cached.
+		thread_local bool destroyed = false;
+		if (destroyed) {
+			return nullptr;
+		}
+		thread_local Cached cached{{}, false, destroyed};
+		if (cached.inUse) {
+			return nullptr;
+		}
+		cached.inUse = true;
+		cached.buffer.clear();
+		return &cached;
+	}
+
+	Cached *d_cached;
+	Buffer  d_local;
+};
+
+// Sinks whose output is buffered, and must be flushed on Flush() requests.
+template <typename T>
+concept OutputFlusher = requires(T &sink) {
+	{ sink.FlushOutput() };
+};
+
 template <typename T, ConcurencyMode CM> class Sink : public slog::Sink {
 public:
-	using LevelArray = std::array<bool, NumLevels>;
+	// Whether the records are written on the logging thread. Only such sinks
+	// can type a Logger.
+	constexpr static bool Synchronous = (CM & Async) == 0;
 
-	inline Sink(const LevelArray &levels, Formatter formatter)
-	    : d_levels{levels}
+	inline Sink(const BaseSinkConfig &config, Formatter formatter)
+	    : d_levels{config.levels}
 	    , d_formatter{formatter} {}
 
 	inline bool AllocateOnStack() const noexcept override {
-		return (CM & Async) != 0;
+		return Synchronous;
 	}
 
 	inline bool Enabled(Level lvl) const noexcept override {
-		auto index = size_t(lvl) + 1;
-		if (index >= NumLevels) {
-			index = 0;
-		}
-		return d_levels[index];
+		return d_levels.Enabled(lvl);
+	}
+
+	inline const LevelMask *EnabledLevels() const noexcept override {
+		return &d_levels;
 	}
 
 	inline void From(Level lvl) noexcept override {
-		auto index = size_t(lvl) + 1;
-		for (size_t i = 1; i < NumLevels; i++) {
-			d_levels[i] = i >= index;
-		}
+		d_levels.From(lvl);
 	}
 
 	inline void Set(Level lvl, bool enabled) noexcept override {
-		auto index = size_t(lvl) + 1;
-		if (index >= NumLevels) {
-			return;
-		}
-		d_levels[index] = enabled;
+		d_levels.Set(lvl, enabled);
 	}
 
 	inline void Log(slog::Sink::RecordVariant &&record) override {
 		static_cast<T *>(this)->LogImpl(std::move(record));
 	}
 
+	using slog::Sink::Flush;
+
+	// the records are already written, the barrier is released on return.
+	inline void Flush(std::shared_ptr<FlushBarrier>) override {
+		flushOutput();
+	}
+
 	void LogImpl(slog::Sink::RecordVariant &&record) {
-		Buffer buffer;
-		buffer.reserve(256);
+		write([this, &record](Buffer &buffer) { Format(record, buffer); });
+	}
+
+	// Formats record with format, and writes it. Called without virtual
+	// dispatch by the loggers typed with the sink.
+	template <typename Format>
+	inline void LogRecord(const slog::Record &record, Format &&format) {
+		write([&record, &format](Buffer &buffer) { format(record, buffer); });
+	}
+
+	inline void LogRecord(const slog::Record &record) {
+		LogRecord(record, d_formatter);
+	}
+
+	// Appends the formatted record to buffer.
+	inline void
+	Format(const slog::Sink::RecordVariant &record, Buffer &buffer) const {
 		std::visit(
 		    [this, &buffer](auto &&arg) { d_formatter(*arg, buffer); },
 		    record
 		);
-		static_cast<T *>(this)->Log(buffer);
 	}
 
 	Sink(const Sink &) = default;
@@ -80,9 +174,33 @@ public:
 	Sink &operator=(const Sink &) = default;
 	Sink &operator=(Sink &&)      = default;
 
+protected:
+	inline void flushOutput() {
+		if constexpr (OutputFlusher<T>) {
+			static_cast<T *>(this)->FlushOutput();
+		}
+	}
+
 private:
-	LevelArray d_levels;
-	Formatter  d_formatter;
+	// Calls format on a buffer reusing the capacity of previously formatted
+	// records, then writes it: the buffer of the logging thread for
+	// synchronous sinks, or one from bufferPool for the drain jobs of
+	// asynchronous ones.
+	template <typename Format> inline void write(Format &&format) {
+		if constexpr (T::Synchronous) {
+			ThreadBuffer buffer;
+			format(*buffer);
+			static_cast<T *>(this)->Log(*buffer);
+		} else {
+			auto buffer = bufferPool.Get();
+			buffer->clear();
+			format(*buffer);
+			static_cast<T *>(this)->Log(*buffer);
+		}
+	}
+
+	LevelMask d_levels;
+	Formatter d_formatter;
 };
 
 template <typename T> class Sink<T, MTSafe> : public Sink<T, Unsafe> {
@@ -96,53 +214,662 @@ public:
 		static_cast<T *>(this)->LogImpl(std::move(record));
 	}
 
+	template <typename Format>
+	inline void LogRecord(const slog::Record &record, Format &&format) {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		Sink<T, Unsafe>::LogRecord(record, std::forward<Format>(format));
+	}
+
+	inline void LogRecord(const slog::Record &record) {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		Sink<T, Unsafe>::LogRecord(record);
+	}
+
+	using slog::Sink::Flush;
+
+	void Flush(std::shared_ptr<FlushBarrier>) override {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		this->flushOutput();
+	}
+
 protected:
 	std::mutex d_mutex;
 };
 
-template <typename T>
-class Sink<T, Async> : public Sink<T, Unsafe>,
-                       public std::enable_shared_from_this<Sink<T, Async>> {
+// Queue of the records waiting to be consumed by an asynchronous sink. Item is
+// either a RecordVariant or an EncodedRecord. Either all producers share a
+// single RingBuffer, or each producer thread pushes in its own lane and the
+// consumer merges them by timestamp.
+template <typename Item> class RecordQueue {
 public:
-	template <typename... Args>
-	inline Sink(Args &&...args)
-	    : Sink<T, Unsafe>(std::forward<Args>(args)...) {}
+	constexpr static size_t SharedCapacity   = 8192;
+	constexpr static size_t LaneCapacity     = 1024;
+	constexpr static size_t PriorityCapacity = 1024;
 
-	void Log(slog::Sink::RecordVariant &&record) override {
-		auto self = this->shared_from_this();
-		threadPool.Queue(
-		    [self](slog::Sink::RecordVariant &&record) {
-			    static_cast<T *>(self.get())->LogImpl(std::move(record));
-		    },
-		    std::move(record)
-		);
+	inline RecordQueue(const BaseSinkConfig &config) {
+		if (config.perThreadQueues) {
+			d_perThread = std::make_unique<PerThreadQueue>(
+			    config.queueCapacity > 0 ? config.queueCapacity : LaneCapacity
+			);
+		} else {
+			d_shared = std::make_unique<SharedQueue>(
+			    config.queueCapacity > 0 ? config.queueCapacity : SharedCapacity
+			);
+		}
 	}
+
+	// A queue shared by all producers.
+	inline explicit RecordQueue(size_t capacity)
+	    : d_shared{std::make_unique<SharedQueue>(capacity)} {}
+
+	inline bool TryPush(Item &item) {
+		return d_shared ? d_shared->TryPush(item) : d_perThread->TryPush(item);
+	}
+
+	inline bool TryPop(Item &item) {
+		return d_shared ? d_shared->TryPop(item) : d_perThread->TryPop(item);
+	}
+
+	// Removes the oldest item the calling producer can reach. Unlike
+	// TryPop(), it is safe to call concurrently with the consumer.
+	inline bool TryEvict(Item &item) {
+		return d_shared ? d_shared->TryPop(item) : d_perThread->TryEvict(item);
+	}
+
+	inline bool Empty() {
+		return d_shared ? d_shared->Empty() : d_perThread->Empty();
+	}
+
+private:
+	struct TimestampLess {
+		inline bool
+		operator()(const Item &a, const Item &b) const noexcept {
+			return timestamp(a) < timestamp(b);
+		}
+
+		inline static TimeT timestamp(const slog::Sink::RecordVariant &record
+		) noexcept {
+			return std::visit(
+			    [](const auto &r) -> TimeT { return r->timestamp; },
+			    record
+			);
+		}
+
+		inline static TimeT timestamp(const EncodedRecord &record) noexcept {
+			return record.Timestamp();
+		}
+	};
+
+	using SharedQueue    = utils::RingBuffer<Item>;
+	using PerThreadQueue = utils::PerThreadQueue<Item, TimestampLess>;
+
+	std::unique_ptr<SharedQueue>    d_shared;
+	std::unique_ptr<PerThreadQueue> d_perThread;
 };
 
+// Sinks that can write many newline terminated records at once. LogBatch()
+// returns the number of records it failed to write.
 template <typename T>
-class Sink<T, AsyncMtSafe>
-    : public Sink<T, Unsafe>,
-      public std::enable_shared_from_this<Sink<T, AsyncMtSafe>> {
+concept BatchLogger = requires(T &sink, const Buffer &batch) {
+	{ sink.LogBatch(batch) } -> std::convertible_to<size_t>;
+};
+
+// Common implementation of asynchronous sinks. Records are pushed by the
+// producers in a bounded lock-free queue, and consumed by a single drain job
+// at a time, scheduled on threadPool when the sink transitions from idle to
+// busy. Once idle, the job yields a few times before returning, so that a
+// burst of records is not scheduled for each of them. Producers only push
+// their record and read whether the sink is idle, which AsymmetricBarrier
+// makes safe without a fence on their side. If T is a BatchLogger, the job
+// formats the records in batches, bounded by a number of records and bytes,
+// to write each of them at once.
+//
+// Once woken up for the first time, the sink is registered in asyncSinks(),
+// which drains it before a Fatal() abort, or at exit if requested.
+//
+// With a dedicated writer, the records are instead drained by a worker
+// running on a thread owned by the sink, optionally pinned to the writer
+// CPUs, so a slow sink cannot delay the others. Once idle, the worker sleeps
+// on a futex until a producer wakes it, without going through a job queue.
+//
+// With deferred formatting, the sink lets loggers build their records on the
+// stack, and producers only encode them as EncodedRecord in the queue. The
+// records are then rebuilt and formatted by the consumer.
+//
+// With a priority lane, the records from the priority level are pushed in a
+// second queue, which the consumer empties before each record of the main
+// one, and flushes right away. With synchronous priority, they are instead
+// written on the logging thread, which then shares the output with the
+// consumer through d_mutex.
+template <typename T, bool Locking>
+class AsyncSink : public Sink<T, Unsafe>,
+                  public std::enable_shared_from_this<AsyncSink<T, Locking>> {
 public:
-	template <typename... Args>
-	inline Sink(Args &&...args)
-	    : Sink<T, Unsafe>(std::forward<Args>(args)...) {}
+	using RecordVariant = slog::Sink::RecordVariant;
 
-	void Log(slog::Sink::RecordVariant &&record) override {
-		auto self = this->shared_from_this();
-		threadPool.Queue(
-		    [self](slog::Sink::RecordVariant &&record) {
-			    std::scoped_lock<std::mutex> lock(self->d_mutex);
-			    static_cast<T *>(self.get())->LogImpl(std::move(record));
-		    },
-		    std::move(record)
+	constexpr static bool Synchronous = false;
+
+	inline AsyncSink(const BaseSinkConfig &config, Formatter formatter)
+	    : Sink<T, Unsafe>(config, formatter)
+	    , d_overflowPolicy{config.overflowPolicy}
+	    , d_blockTimeout{config.blockTimeout}
+	    , d_sampleRate{std::max(config.sampleRate, size_t(1))}
+	    , d_batchRecords{std::max(config.batchRecords, size_t(1))}
+	    , d_batchBytes{config.batchBytes}
+	    , d_priorityLevel{
+	          config.priorityLane ? config.priorityLevel : Level::Unknown
+	      }
+	    , d_prioritySynchronous{
+	          config.priorityLane && config.prioritySynchronous
+	      }
+	    , d_lastReport{std::chrono::steady_clock::now()} {
+		const bool priorityLane =
+		    config.priorityLane && config.prioritySynchronous == false;
+		if (config.deferredFormatting) {
+			using Queue = RecordQueue<EncodedRecord>;
+			d_encoded   = std::make_unique<Queue>(config);
+			if (priorityLane) {
+				d_priorityEncoded =
+				    std::make_unique<Queue>(Queue::PriorityCapacity);
+			}
+		} else {
+			using Queue = RecordQueue<RecordVariant>;
+			d_records   = std::make_unique<Queue>(config);
+			if (priorityLane) {
+				d_priorityRecords =
+				    std::make_unique<Queue>(Queue::PriorityCapacity);
+			}
+		}
+		if (config.dedicatedWriter) {
+			d_worker = std::make_shared<WorkerState>();
+			d_writer = std::make_unique<utils::ThreadPool>();
+			d_writer->SetSize(1);
+			if (config.writerCpus.empty() == false &&
+			    !d_writer->SetAffinity(config.writerCpus)) {
+				throw std::runtime_error("cannot pin the writer to its CPUs");
+			}
+		}
+	}
+
+	// The drain job or worker holds the sink while it has records to drain,
+	// so none are left once it is destroyed, and a dedicated worker only has
+	// to exit. It may also be the thread destroying the sink.
+	inline ~AsyncSink() {
+		if (d_worker) {
+			d_worker->woken.store(true, std::memory_order_release);
+			d_worker->woken.notify_one();
+		}
+	}
+
+	inline bool AllocateOnStack() const noexcept override {
+		return d_encoded != nullptr;
+	}
+
+	void Log(RecordVariant &&record) override {
+		auto *ptr = std::visit(
+		    [](const auto &r) -> const slog::Record * { return &*r; },
+		    record
 		);
+		const bool priority = d_priorityLevel != Level::Unknown &&
+		                      ptr->level >= d_priorityLevel;
+		if (priority && d_prioritySynchronous) {
+			writeSynchronously(*ptr);
+			return;
+		}
+
+		if (d_encoded) {
+			EncodedRecord encoded(*ptr);
+			push(priority ? *d_priorityEncoded : *d_encoded, encoded);
+			return;
+		}
+
+		auto &queue = priority ? *d_priorityRecords : *d_records;
+		if (std::holds_alternative<const slog::Record *>(record)) {
+			// the record does not outlive this call, a copy is queued, as
+			// writing it here would race with the consumer.
+			RecordVariant copy{
+			    std::in_place_type<std::unique_ptr<const slog::Record>>,
+			    std::make_unique<const DecodedRecord>(EncodedRecord{*ptr})
+			};
+			push(queue, copy);
+			return;
+		}
+		push(queue, record);
+	}
+
+	using slog::Sink::Flush;
+
+	// The barrier is released by the consumer, once it consumed all the
+	// records pushed before the call.
+	void Flush(std::shared_ptr<FlushBarrier> barrier) override {
+		{
+			std::scoped_lock<std::mutex> lock(d_flushMutex);
+			d_flushes.push_back(std::move(barrier));
+		}
+		wake();
+	}
+
+	// Returns the number of records dropped since the sink creation, either
+	// from the queue, or by a failed batch write.
+	inline uint64_t Dropped() const noexcept {
+		return d_dropped.load(std::memory_order_relaxed);
+	}
+
+	// Returns the number of producers waiting for room in a full queue.
+	inline size_t Waiting() const noexcept {
+		return d_waiting.load(std::memory_order_relaxed);
+	}
+
+	// Returns true if no drain job or worker is running, that is once the
+	// queued records are written and the consumer went to sleep.
+	inline bool Idle() const noexcept {
+		return d_parked.load(std::memory_order_acquire);
 	}
 
 private:
-	std::mutex d_mutex;
+	// The minimal period between two reports of dropped records, while the
+	// queue is not emptied.
+	constexpr static auto DropReportPeriod = std::chrono::seconds(1);
+	// The number of times an idle drain yields before returning, so that a
+	// burst of records does not wake it up for each of them.
+	constexpr static int IdleYields = 16;
+
+	// Shared with the dedicated worker, which outlives the sink when it
+	// releases the last reference to it.
+	struct WorkerState {
+		// set along with sink by the producer waking the worker, or without
+		// it once the sink is destroyed.
+		std::atomic<bool>          woken{false};
+		std::shared_ptr<AsyncSink> sink;
+	};
+
+	template <typename Item>
+	inline void push(RecordQueue<Item> &queue, Item &item) {
+		if (queue.TryPush(item) == false && overflow(queue, item) == false) {
+			d_dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+		wake();
+	}
+
+	// Handles a full queue according to the overflow policy. Returns false if
+	// the item is dropped.
+	template <typename Item>
+	inline bool overflow(RecordQueue<Item> &queue, Item &item) {
+		switch (d_overflowPolicy) {
+		case OverflowPolicy::DropNewest:
+			return false;
+		case OverflowPolicy::DropOldest: {
+			Item oldest;
+			while (queue.TryPush(item) == false) {
+				if (queue.TryEvict(oldest) == true) {
+					d_dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			return true;
+		}
+		case OverflowPolicy::Sample:
+			if (d_sampled.fetch_add(1, std::memory_order_relaxed) %
+			        d_sampleRate !=
+			    0) {
+				return false;
+			}
+			break;
+		case OverflowPolicy::Block:
+		default:
+			break;
+		}
+		d_waiting.fetch_add(1, std::memory_order_relaxed);
+		const bool pushed = waitForRoom(queue, item);
+		d_waiting.fetch_sub(1, std::memory_order_relaxed);
+		return pushed;
+	}
+
+	// Retries to push item until the block timeout expires. The producer
+	// first yields, then sleeps for exponentially longer periods, so that a
+	// slow consumer does not keep it spinning.
+	template <typename Item>
+	inline bool waitForRoom(RecordQueue<Item> &queue, Item &item) {
+		using clock                      = std::chrono::steady_clock;
+		constexpr static int  Yields     = 16;
+		constexpr static auto MaxBackoff = std::chrono::milliseconds(1);
+
+		const auto deadline = d_blockTimeout == DurationT::max()
+		                          ? clock::time_point::max()
+		                          : clock::now() + d_blockTimeout;
+		int                      yields  = 0;
+		std::chrono::nanoseconds backoff = std::chrono::microseconds(1);
+		while (true) {
+			// ensures that the queue is being drained.
+			wake();
+			if (yields < Yields) {
+				++yields;
+				std::this_thread::yield();
+			} else {
+				std::this_thread::sleep_for(std::min<clock::duration>(
+				    backoff,
+				    deadline - clock::now()
+				));
+				backoff = std::min<std::chrono::nanoseconds>(
+				    backoff * 2,
+				    MaxBackoff
+				);
+			}
+			if (queue.TryPush(item) == true) {
+				return true;
+			}
+			if (clock::now() >= deadline) {
+				return false;
+			}
+		}
+	}
+
+	// Schedules a drain job, or wakes the dedicated worker up, if the sink is
+	// idle. The worker is started on the first call. The barrier pairs with
+	// the one in drain(): either we see that the sink is idle, or it sees
+	// what we pushed before. The job, or the worker, holds a reference to the
+	// sink, so that the records we pushed are drained even if we release the
+	// sink right after.
+	inline void wake() {
+		utils::AsymmetricBarrier::Light();
+		if (d_parked.load(std::memory_order_relaxed) == false ||
+		    d_parked.exchange(false, std::memory_order_acq_rel) == false) {
+			return;
+		}
+		std::call_once(d_started, [this]() {
+			asyncSinks().Register(this->weak_from_this());
+			if (d_worker) {
+				d_writer->Queue([state = d_worker]() { work(*state); });
+			}
+		});
+		if (d_worker == nullptr) {
+			threadPool.Queue([self = this->shared_from_this()]() {
+				self->drain();
+			});
+			return;
+		}
+		// only this producer can touch state.sink until drain() marks the
+		// sink as idle again.
+		auto &state = *d_worker;
+		state.sink  = this->shared_from_this();
+		state.woken.store(true, std::memory_order_release);
+		state.woken.notify_one();
+	}
+
+	// Runs on d_writer until the sink is destroyed. The worker holds the
+	// reference it was handed while draining the sink, and once it released
+	// it, only touches state, as the sink may be gone.
+	inline static void work(WorkerState &state) {
+		while (true) {
+			state.woken.wait(false, std::memory_order_acquire);
+			state.woken.store(false, std::memory_order_relaxed);
+			auto self = std::move(state.sink);
+			if (self == nullptr) {
+				return;
+			}
+			self->drain();
+		}
+	}
+
+	// Consumes the records and flush requests until the sink is idle, then
+	// marks it as such.
+	inline void drain() {
+		int yields = 0;
+		while (true) {
+			// only the records pushed before these requests must be drained
+			// to complete them.
+			auto flushes = takeFlushes();
+			if (d_encoded) {
+				drainQueue(*d_encoded, d_priorityEncoded.get());
+			} else {
+				drainQueue(*d_records, d_priorityRecords.get());
+			}
+			writeBatch();
+			reportDropped(true);
+			if (flushes.empty() == false) {
+				flushOutput();
+				flushes.clear();
+			}
+
+			while (idle() && yields < IdleYields) {
+				++yields;
+				std::this_thread::yield();
+			}
+			if (idle() == false) {
+				yields = 0;
+				continue;
+			}
+
+			// releases the handed reference to the next waking producer.
+			d_parked.store(true, std::memory_order_release);
+			// pairs with the barrier in wake(). If a producer already took
+			// over the sink, it scheduled another drain, which must be the
+			// only one.
+			utils::AsymmetricBarrier::Heavy();
+			if (idle() ||
+			    d_parked.exchange(false, std::memory_order_acq_rel) == false) {
+				return;
+			}
+			yields = 0;
+		}
+	}
+
+	inline bool idle() {
+		return empty() && hasFlushes() == false;
+	}
+
+	inline bool empty() {
+		if (d_encoded) {
+			return d_encoded->Empty() &&
+			       (d_priorityEncoded == nullptr || d_priorityEncoded->Empty());
+		}
+		return d_records->Empty() &&
+		       (d_priorityRecords == nullptr || d_priorityRecords->Empty());
+	}
+
+	inline std::vector<std::shared_ptr<FlushBarrier>> takeFlushes() {
+		std::vector<std::shared_ptr<FlushBarrier>> res;
+		std::scoped_lock<std::mutex>               lock(d_flushMutex);
+		res.swap(d_flushes);
+		return res;
+	}
+
+	inline bool hasFlushes() {
+		std::scoped_lock<std::mutex> lock(d_flushMutex);
+		return d_flushes.empty() == false;
+	}
+
+	// Calls f with exclusive access to the output, if other threads than the
+	// consumer can write to it.
+	template <typename F> inline void withOutput(F &&f) {
+		if (Locking || d_prioritySynchronous) {
+			std::scoped_lock<std::mutex> lock(d_mutex);
+			f();
+		} else {
+			f();
+		}
+	}
+
+	inline void flushOutput() {
+		withOutput([this]() { Sink<T, Unsafe>::flushOutput(); });
+	}
+
+	inline void writeSynchronously(const slog::Record &record) {
+		withOutput([this, &record]() {
+			static_cast<T *>(this)->LogImpl(&record);
+			Sink<T, Unsafe>::flushOutput();
+		});
+	}
+
+	template <typename Item>
+	inline void
+	drainQueue(RecordQueue<Item> &queue, RecordQueue<Item> *priority) {
+		Item   item;
+		size_t batched = 0;
+		while (true) {
+			if (priority != nullptr) {
+				drainPriority(*priority, batched);
+			}
+			if (queue.TryPop(item) == false) {
+				return;
+			}
+			consumeItem(item, batched);
+			reportDropped(false);
+		}
+	}
+
+	// Writes and flushes the queued priority records, along with the batch
+	// they are appended to.
+	template <typename Item>
+	inline void drainPriority(RecordQueue<Item> &priority, size_t &batched) {
+		Item item;
+		if (priority.TryPop(item) == false) {
+			return;
+		}
+		do {
+			consumeItem(item, batched);
+		} while (priority.TryPop(item));
+		writeBatch();
+		batched = 0;
+		flushOutput();
+	}
+
+	template <typename Item>
+	inline void consumeItem(Item &item, size_t &batched) {
+		if constexpr (std::is_same_v<Item, EncodedRecord>) {
+			consumeOrBatch(DecodedRecord{item}, batched);
+		} else {
+			std::visit(
+			    [this, &batched](const auto &r) {
+				    consumeOrBatch(*r, batched);
+			    },
+			    item
+			);
+			// releases the record right away.
+			item = RecordVariant{};
+		}
+	}
+
+	inline void consumeOrBatch(const slog::Record &record, size_t &batched) {
+		if constexpr (BatchLogger<T>) {
+			this->Format(&record, d_batch);
+			d_batch.push_back('\n');
+			if (++batched >= d_batchRecords || d_batch.size() >= d_batchBytes) {
+				writeBatch();
+				batched = 0;
+			}
+		} else {
+			consume(record);
+		}
+	}
+
+	// Emits a synthetic record with the number of records dropped since the
+	// last report. Unless force is set, reports are at most emitted once per
+	// DropReportPeriod.
+	inline void reportDropped(bool force) {
+		auto dropped = d_dropped.load(std::memory_order_relaxed);
+		if (dropped == d_reported) {
+			return;
+		}
+		auto now = std::chrono::steady_clock::now();
+		if (force == false && now - d_lastReport < DropReportPeriod) {
+			return;
+		}
+
+		details::Record<1> report(
+		    Level::Warn,
+		    "records dropped",
+		    Int("dropped", dropped - d_reported)
+		);
+		d_reported   = dropped;
+		d_lastReport = now;
+		// keeps the report after the records it follows.
+		writeBatch();
+		consume(report);
+	}
+
+	inline void writeBatch() {
+		if constexpr (BatchLogger<T>) {
+			if (d_batch.empty()) {
+				return;
+			}
+			size_t lost = 0;
+			withOutput([this, &lost]() {
+				lost = static_cast<T *>(this)->LogBatch(d_batch);
+			});
+			// reported as the records dropped from the queue.
+			d_dropped.fetch_add(lost, std::memory_order_relaxed);
+			d_batch.clear();
+		}
+	}
+
+	inline void consume(const slog::Record &record) {
+		withOutput([this, &record]() {
+			static_cast<T *>(this)->LogImpl(&record);
+		});
+	}
+
+	// only one of them is set, along with its priority lane if any.
+	std::unique_ptr<RecordQueue<RecordVariant>> d_records;
+	std::unique_ptr<RecordQueue<EncodedRecord>> d_encoded;
+	std::unique_ptr<RecordQueue<RecordVariant>> d_priorityRecords;
+	std::unique_ptr<RecordQueue<EncodedRecord>> d_priorityEncoded;
+	std::mutex                                  d_mutex;
+	// registers the sink in asyncSinks(), and starts the dedicated worker.
+	std::once_flag                              d_started;
+	// set while no drain job or worker runs, cleared by the producer
+	// scheduling one.
+	std::atomic<bool>                           d_parked{true};
+	// only set with a dedicated writer.
+	std::shared_ptr<WorkerState>                d_worker;
+	// if set, the single thread running the dedicated worker.
+	std::unique_ptr<utils::ThreadPool>          d_writer;
+
+	// pending Flush() requests, protected by d_flushMutex.
+	std::mutex                                 d_flushMutex;
+	std::vector<std::shared_ptr<FlushBarrier>> d_flushes;
+
+	const OverflowPolicy  d_overflowPolicy;
+	const DurationT       d_blockTimeout;
+	const size_t          d_sampleRate;
+	std::atomic<uint64_t> d_sampled{0};
+	std::atomic<uint64_t> d_dropped{0};
+	std::atomic<size_t>   d_waiting{0};
+
+	const size_t d_batchRecords;
+	const size_t d_batchBytes;
+
+	// Level::Unknown if there is no priority lane.
+	const Level d_priorityLevel;
+	const bool  d_prioritySynchronous;
+
+	// consumer only state.
+	uint64_t                              d_reported = 0;
+	std::chrono::steady_clock::time_point d_lastReport;
+	Buffer                                d_batch;
+};
+
+template <typename T> class Sink<T, Async> : public AsyncSink<T, false> {
+public:
+	template <typename... Args>
+	inline Sink(Args &&...args)
+	    : AsyncSink<T, false>(std::forward<Args>(args)...) {}
+};
+
+template <typename T> class Sink<T, AsyncMtSafe> : public AsyncSink<T, true> {
+public:
+	template <typename... Args>
+	inline Sink(Args &&...args)
+	    : AsyncSink<T, true>(std::forward<Args>(args)...) {}
 };
 
 } // namespace details
 
+// The concurrency modes of a sink, such as FileSink<MTSafe>. STSafe sinks
+// must be used by a single thread at a time, MTSafe ones lock. Async sinks
+// write their records on a background thread.
+inline constexpr details::ConcurencyMode STSafe      = details::Unsafe;
+inline constexpr details::ConcurencyMode MTSafe      = details::MTSafe;
+inline constexpr details::ConcurencyMode Async       = details::Async;
+inline constexpr details::ConcurencyMode AsyncMTSafe = details::AsyncMtSafe;
+
 } // namespace slog
@@ -0,0 +1,968 @@
+#include "SinkDetails.hpp"
+#include "Logger.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace slog {
+namespace details {
+
+// A sink that collects its formatted records, and whose consumer can be
+// blocked to fill its queue. If Batching is set, it is a BatchLogger.
+template <ConcurencyMode CM, bool Batching = false>
+class CollectingSink : public Sink<CollectingSink<CM, Batching>, CM> {
+public:
+	using Base = Sink<CollectingSink<CM, Batching>, CM>;
+
+	inline CollectingSink(
+	    const BaseSinkConfig &config, Formatter formatter = &RecordToRawText
+	)
+	    : Base(config, formatter) {}
+
+	void Log(const Buffer &buffer) {
+		collect({buffer});
+	}
+
+	size_t LogBatch(const Buffer &batch)
+	    requires Batching
+	{
+		std::vector<std::string> lines;
+		std::istringstream       in(batch);
+		for (std::string line; std::getline(in, line);) {
+			lines.push_back(line);
+		}
+		if (d_failing) {
+			return lines.size();
+		}
+		collect(lines);
+		return 0;
+	}
+
+	// Makes the next batches fail, as a full disk would.
+	void Fail() {
+		d_failing = true;
+	}
+
+	void Block() {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		d_blocked = true;
+	}
+
+	void Unblock() {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		d_blocked = false;
+		d_condition.notify_all();
+	}
+
+	// Lets a blocked consumer collect one more record, and waits for it.
+	void Step() {
+		std::unique_lock<std::mutex> lock(d_mutex);
+		const auto                   collected = d_lines.size();
+		++d_steps;
+		d_condition.notify_all();
+		d_condition.wait(lock, [this, collected]() {
+			return d_lines.size() > collected;
+		});
+	}
+
+	void WaitConsuming() {
+		std::unique_lock<std::mutex> lock(d_mutex);
+		d_condition.wait(lock, [this]() { return d_consuming; });
+	}
+
+	std::vector<std::string> WaitLines(size_t count) {
+		std::unique_lock<std::mutex> lock(d_mutex);
+		d_condition.wait(lock, [this, count]() {
+			return d_lines.size() >= count;
+		});
+		return d_lines;
+	}
+
+	std::vector<size_t> Batches() {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		return d_batches;
+	}
+
+	void FlushOutput() {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		++d_flushed;
+	}
+
+	size_t Flushed() {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		return d_flushed;
+	}
+
+private:
+	void collect(const std::vector<std::string> &lines) {
+		std::unique_lock<std::mutex> lock(d_mutex);
+		d_consuming = true;
+		d_condition.notify_all();
+		d_condition.wait(lock, [this]() {
+			return d_blocked == false || d_steps > 0;
+		});
+		if (d_blocked) {
+			--d_steps;
+		}
+		d_lines.insert(d_lines.end(), lines.begin(), lines.end());
+		d_batches.push_back(lines.size());
+		d_condition.notify_all();
+	}
+
+	std::mutex               d_mutex;
+	std::condition_variable  d_condition;
+	bool                     d_blocked   = false;
+	bool                     d_consuming = false;
+	size_t                   d_steps     = 0;
+	std::vector<std::string> d_lines;
+	std::vector<size_t>      d_batches;
+	size_t                   d_flushed = 0;
+	std::atomic<bool>        d_failing{false};
+};
+
+class AsyncSinkTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		threadPool.SetSize(1);
+	}
+
+	void TearDown() override {
+		threadPool.SetSize(0);
+	}
+
+	static BaseSinkConfig config(OverflowPolicy policy) {
+		BaseSinkConfig config;
+		FromLevel(Level::Trace)(config);
+		WithAsync()(config);
+		WithQueueCapacity(4)(config);
+		WithOverflowPolicy(policy)(config);
+		return config;
+	}
+
+	// Polls condition until it holds, or fails after a timeout rather than
+	// hanging on a regression.
+	template <typename Condition> static bool waitUntil(Condition &&condition) {
+		const auto deadline =
+		    std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (condition() == false) {
+			if (std::chrono::steady_clock::now() >= deadline) {
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		return true;
+	}
+
+	// Logs a first record that blocks the consumer, then count records.
+	template <typename Sink>
+	static void fill(Sink &sink, Logger<0> &logger, int count) {
+		sink.Block();
+		logger.Info("0");
+		sink.WaitConsuming();
+		for (int i = 1; i <= count; ++i) {
+			logger.Info(std::to_string(i));
+		}
+	}
+};
+
+using ::testing::ElementsAre;
+using ::testing::EndsWith;
+
+TEST_F(AsyncSinkTest, DoesNotAllocateOnStack) {
+	auto sink = std::make_shared<CollectingSink<Async>>(BaseSinkConfig{});
+	EXPECT_FALSE(sink->AllocateOnStack());
+	auto syncSink = std::make_shared<CollectingSink<MTSafe>>(BaseSinkConfig{});
+	EXPECT_TRUE(syncSink->AllocateOnStack());
+}
+
+TEST_F(AsyncSinkTest, ReusesBuffers) {
+	auto sink =
+	    std::make_shared<CollectingSink<Async>>(config(OverflowPolicy::Block));
+	Logger<0> logger(sink);
+
+	logger.Info("0");
+	sink->Flush().wait();
+	const auto capacity = bufferPool.Capacity();
+	for (int i = 1; i <= 100; ++i) {
+		logger.Info(std::to_string(i));
+	}
+	sink->Flush().wait();
+	EXPECT_EQ(bufferPool.Capacity(), capacity);
+	EXPECT_EQ(bufferPool.Available(), capacity);
+	EXPECT_THAT(sink->WaitLines(101).back(), EndsWith("INFO 100"));
+}
+
+TEST_F(AsyncSinkTest, WakesSleepingWorker) {
+	for (bool dedicated : {false, true}) {
+		SCOPED_TRACE(dedicated ? "dedicated writer" : "shared pool");
+		auto baseConfig = config(OverflowPolicy::Block);
+		if (dedicated) {
+			WithDedicatedWriter()(baseConfig);
+		}
+		auto      sink = std::make_shared<CollectingSink<Async>>(baseConfig);
+		Logger<0> logger(sink);
+
+		for (size_t i = 0; i < 10; ++i) {
+			logger.Info(std::to_string(i));
+			EXPECT_THAT(
+			    sink->WaitLines(i + 1).back(),
+			    EndsWith(std::to_string(i))
+			);
+			// lets the consumer go to sleep.
+			ASSERT_TRUE(waitUntil([&sink]() { return sink->Idle(); }));
+		}
+	}
+}
+
+// Lines written by a sink, which outlive it.
+class SharedLines {
+public:
+	void Add(const std::string &line) {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		d_lines.push_back(line);
+		d_condition.notify_all();
+	}
+
+	// Returns false if there are less than count lines after timeout.
+	bool Wait(size_t count, std::chrono::milliseconds timeout) {
+		std::unique_lock<std::mutex> lock(d_mutex);
+		return d_condition.wait_for(lock, timeout, [this, count]() {
+			return d_lines.size() >= count;
+		});
+	}
+
+	std::vector<std::string> Lines() {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		return d_lines;
+	}
+
+private:
+	std::mutex               d_mutex;
+	std::condition_variable  d_condition;
+	std::vector<std::string> d_lines;
+};
+
+class SharingSink : public Sink<SharingSink, Async> {
+public:
+	inline SharingSink(
+	    const BaseSinkConfig &config, std::shared_ptr<SharedLines> lines
+	)
+	    : Sink<SharingSink, Async>(config, &RecordToRawText)
+	    , d_lines{std::move(lines)} {}
+
+	void Log(const Buffer &buffer) {
+		d_lines->Add(buffer);
+	}
+
+private:
+	std::shared_ptr<SharedLines> d_lines;
+};
+
+TEST_F(AsyncSinkTest, DrainedOnceReleased) {
+	constexpr static size_t Count = 100;
+
+	auto lines      = std::make_shared<SharedLines>();
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithQueueCapacity(Count)(baseConfig);
+	std::weak_ptr<SharingSink> weak;
+	{
+		auto sink = std::make_shared<SharingSink>(baseConfig, lines);
+		weak      = sink;
+		Logger<0> logger(sink);
+		for (size_t i = 0; i < Count; ++i) {
+			logger.Info(std::to_string(i));
+		}
+	}
+
+	// the worker holds the sink until it is done draining it.
+	ASSERT_TRUE(lines->Wait(Count, std::chrono::seconds(10)));
+	EXPECT_THAT(lines->Lines().back(), EndsWith(std::to_string(Count - 1)));
+	const auto deadline =
+	    std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (weak.expired() == false &&
+	       std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::yield();
+	}
+	EXPECT_TRUE(weak.expired());
+}
+
+TEST_F(AsyncSinkTest, DedicatedWriter) {
+	auto shared =
+	    std::make_shared<CollectingSink<Async>>(config(OverflowPolicy::Block));
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithDedicatedWriter()(baseConfig);
+	auto dedicated = std::make_shared<CollectingSink<Async>>(baseConfig);
+
+	// blocks the shared pool.
+	std::promise<void> release;
+	threadPool.Queue([blocked = release.get_future().share()]() {
+		blocked.wait();
+	});
+
+	Logger<0>(shared).Info("shared");
+	Logger<0>(dedicated).Info("dedicated");
+	auto sharedDone    = shared->Flush();
+	auto dedicatedDone = dedicated->Flush();
+	EXPECT_EQ(
+	    dedicatedDone.wait_for(std::chrono::seconds(10)),
+	    std::future_status::ready
+	);
+	EXPECT_THAT(
+	    dedicated->WaitLines(1),
+	    ElementsAre(EndsWith("INFO dedicated"))
+	);
+	EXPECT_EQ(
+	    sharedDone.wait_for(std::chrono::milliseconds(10)),
+	    std::future_status::timeout
+	);
+
+	release.set_value();
+	sharedDone.wait();
+	EXPECT_THAT(shared->WaitLines(1), ElementsAre(EndsWith("INFO shared")));
+}
+
+TEST_F(AsyncSinkTest, DedicatedWriterAffinity) {
+	EXPECT_THROW(
+	    WithDedicatedWriter({std::numeric_limits<size_t>::max()}),
+	    std::invalid_argument
+	);
+
+	// a valid index, but not a CPU of this machine.
+	const size_t missing = std::thread::hardware_concurrency();
+	if (missing == 0 || !utils::ThreadPool::ValidCPU(missing)) {
+		GTEST_SKIP() << "cannot pin a writer to a missing CPU here";
+	}
+	auto baseConfig = config(OverflowPolicy::DropNewest);
+	WithDedicatedWriter({missing})(baseConfig);
+	EXPECT_THROW(
+	    std::make_shared<CollectingSink<Async>>(baseConfig),
+	    std::runtime_error
+	);
+}
+
+TEST_F(AsyncSinkTest, Flush) {
+	auto sink =
+	    std::make_shared<CollectingSink<Async>>(config(OverflowPolicy::Block));
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 4);
+	auto done = sink->Flush();
+	EXPECT_EQ(
+	    done.wait_for(std::chrono::milliseconds(1)),
+	    std::future_status::timeout
+	);
+
+	sink->Unblock();
+	done.wait();
+	EXPECT_THAT(sink->Batches(), ::testing::SizeIs(5));
+	EXPECT_EQ(sink->Flushed(), 1);
+
+	auto syncSink = std::make_shared<CollectingSink<MTSafe>>(BaseSinkConfig{});
+	EXPECT_EQ(
+	    syncSink->Flush().wait_for(std::chrono::seconds(0)),
+	    std::future_status::ready
+	);
+	EXPECT_EQ(syncSink->Flushed(), 1);
+}
+
+TEST_F(AsyncSinkTest, DrainedBeforeFatalAbort) {
+	auto sink =
+	    std::make_shared<CollectingSink<Async>>(config(OverflowPolicy::Block));
+	Logger<0> logger(sink);
+
+	std::vector<std::string> written;
+	setAbortFunction([&written, &sink]() { written = sink->WaitLines(0); });
+	logger.Info("0");
+	logger.Info("1");
+	logger.Fatal("2");
+	setAbortFunction(std::abort);
+
+	EXPECT_THAT(
+	    written,
+	    ElementsAre(EndsWith("INFO 0"), EndsWith("INFO 1"), EndsWith("FATAL 2"))
+	);
+}
+
+TEST_F(AsyncSinkTest, PriorityLane) {
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithPriorityLane(Level::Error)(baseConfig);
+	auto sink = std::make_shared<CollectingSink<Async>>(baseConfig);
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 4);
+	logger.Error("5");
+	sink->Unblock();
+	EXPECT_THAT(
+	    sink->WaitLines(6),
+	    ElementsAre(
+	        EndsWith("INFO 0"),
+	        EndsWith("ERROR 5"),
+	        EndsWith("INFO 1"),
+	        EndsWith("INFO 2"),
+	        EndsWith("INFO 3"),
+	        EndsWith("INFO 4")
+	    )
+	);
+	EXPECT_GE(sink->Flushed(), 1);
+}
+
+TEST_F(AsyncSinkTest, SynchronousPriority) {
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithDedicatedWriter()(baseConfig);
+	WithSynchronousPriority(Level::Warn)(baseConfig);
+	auto sink = std::make_shared<CollectingSink<Async>>(baseConfig);
+	Logger<0> logger(sink);
+
+	logger.Warn("0");
+	// written and flushed before Warn() returned.
+	EXPECT_THAT(sink->WaitLines(0), ElementsAre(EndsWith("WARN 0")));
+	EXPECT_EQ(sink->Flushed(), 1);
+
+	logger.Info("1");
+	logger.Error("2");
+	sink->Flush().wait();
+	EXPECT_THAT(sink->WaitLines(3), ::testing::Contains(EndsWith("INFO 1")));
+}
+
+TEST_F(AsyncSinkTest, DeferredFormatting) {
+	auto baseConfig = config(OverflowPolicy::DropNewest);
+	WithDeferredFormatting()(baseConfig);
+	auto sink = std::make_shared<CollectingSink<AsyncMtSafe>>(baseConfig);
+	EXPECT_TRUE(sink->AllocateOnStack());
+	auto logger = Logger<0>(sink).With(slog::String("service", "test"));
+
+	sink->Block();
+	logger.Info("0", slog::Group("request", Int("status", 200)));
+	sink->WaitConsuming();
+	for (int i = 1; i <= 5; ++i) {
+		logger.Info(std::to_string(i), Float("aDouble", 1.5));
+	}
+	EXPECT_EQ(sink->Dropped(), 1);
+
+	sink->Unblock();
+	EXPECT_THAT(
+	    sink->WaitLines(6),
+	    ElementsAre(
+	        EndsWith("INFO 0 service=test request.status=200"),
+	        EndsWith("INFO 1 service=test aDouble=1.5"),
+	        EndsWith("INFO 2 service=test aDouble=1.5"),
+	        EndsWith("INFO 3 service=test aDouble=1.5"),
+	        EndsWith("INFO 4 service=test aDouble=1.5"),
+	        EndsWith("WARN \"records dropped\" dropped=1")
+	    )
+	);
+}
+
+TEST_F(AsyncSinkTest, QueuesStackRecords) {
+	auto sink =
+	    std::make_shared<CollectingSink<Async>>(config(OverflowPolicy::Block));
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 1);
+	// written by the worker after the blocked records, rather than by the
+	// logging thread.
+	auto logged = std::async(std::launch::async, [&sink]() {
+		details::Record<1> record(Level::Info, "2", Int("stack", 1));
+		static_cast<slog::Sink &>(*sink).Log(&record);
+	});
+	EXPECT_EQ(
+	    logged.wait_for(std::chrono::seconds(10)),
+	    std::future_status::ready
+	);
+	sink->Unblock();
+	logged.wait();
+
+	EXPECT_THAT(
+	    sink->WaitLines(3),
+	    ElementsAre(
+	        EndsWith("INFO 0"),
+	        EndsWith("INFO 1"),
+	        EndsWith("INFO 2 stack=1")
+	    )
+	);
+}
+
+// Logs local constant arrays, which do not outlive the call.
+[[gnu::noinline]] static void logLocalArrays(Logger<0> &logger) {
+	const char key[]   = "a key longer than the SSO";
+	const char value[] = "a value longer than the SSO";
+	logger.Info("local", slog::String(key, value));
+}
+
+// Overwrites the stack used by logLocalArrays().
+[[gnu::noinline]] static void clobberStack() {
+	volatile char stack[256];
+	for (auto &c : stack) {
+		c = 'X';
+	}
+}
+
+TEST_F(AsyncSinkTest, LocalArraysAreCopied) {
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithDeferredFormatting()(baseConfig);
+	auto sink = std::make_shared<CollectingSink<Async>>(baseConfig);
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 0);
+	logLocalArrays(logger);
+	clobberStack();
+	sink->Unblock();
+
+	EXPECT_THAT(
+	    sink->WaitLines(2),
+	    ElementsAre(
+	        EndsWith("INFO 0"),
+	        EndsWith("INFO local a key longer than the SSO=\"a value longer "
+	                 "than the SSO\"")
+	    )
+	);
+}
+
+TEST_F(AsyncSinkTest, DropNewest) {
+	auto sink = std::make_shared<CollectingSink<Async>>(
+	    config(OverflowPolicy::DropNewest)
+	);
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 7);
+	EXPECT_EQ(sink->Dropped(), 3);
+
+	sink->Unblock();
+	EXPECT_THAT(
+	    sink->WaitLines(6),
+	    ElementsAre(
+	        EndsWith("INFO 0"),
+	        EndsWith("INFO 1"),
+	        EndsWith("INFO 2"),
+	        EndsWith("INFO 3"),
+	        EndsWith("INFO 4"),
+	        EndsWith("WARN \"records dropped\" dropped=3")
+	    )
+	);
+}
+
+TEST_F(AsyncSinkTest, DropOldest) {
+	auto sink = std::make_shared<CollectingSink<AsyncMtSafe>>(
+	    config(OverflowPolicy::DropOldest)
+	);
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 7);
+	EXPECT_EQ(sink->Dropped(), 3);
+
+	sink->Unblock();
+	EXPECT_THAT(
+	    sink->WaitLines(6),
+	    ElementsAre(
+	        EndsWith("INFO 0"),
+	        EndsWith("INFO 4"),
+	        EndsWith("INFO 5"),
+	        EndsWith("INFO 6"),
+	        EndsWith("INFO 7"),
+	        EndsWith("WARN \"records dropped\" dropped=3")
+	    )
+	);
+}
+
+TEST_F(AsyncSinkTest, BlockWaitsForRoom) {
+	auto sink =
+	    std::make_shared<CollectingSink<Async>>(config(OverflowPolicy::Block));
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 4);
+	std::thread producer([&logger]() { logger.Info("5"); });
+	sink->Unblock();
+	producer.join();
+
+	EXPECT_EQ(sink->Dropped(), 0);
+	EXPECT_THAT(sink->WaitLines(6), ::testing::SizeIs(6));
+}
+
+TEST_F(AsyncSinkTest, BlockTimeout) {
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithBlockTimeout(std::chrono::milliseconds(1))(baseConfig);
+	auto sink = std::make_shared<CollectingSink<Async>>(baseConfig);
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 5);
+	EXPECT_EQ(sink->Dropped(), 1);
+
+	sink->Unblock();
+	EXPECT_THAT(
+	    sink->WaitLines(6).back(),
+	    EndsWith("WARN \"records dropped\" dropped=1")
+	);
+}
+
+TEST_F(AsyncSinkTest, Sample) {
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithSampleRate(3)(baseConfig);
+	WithBlockTimeout(std::chrono::seconds(10))(baseConfig);
+	auto sink = std::make_shared<CollectingSink<Async>>(baseConfig);
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 4);
+	// 6 overflowing records: the first of every 3 waits for room.
+	std::jthread producer([&logger]() {
+		for (int i = 5; i <= 10; ++i) {
+			logger.Info(std::to_string(i));
+		}
+	});
+	// on failure, the sink is unblocked so that producer can be joined.
+	const auto waitFor = [&sink](uint64_t dropped, size_t waiting) {
+		const bool res = waitUntil([&sink, dropped, waiting]() {
+			return sink->Dropped() == dropped && sink->Waiting() == waiting;
+		});
+		if (res == false) {
+			sink->Unblock();
+		}
+		return res;
+	};
+	// 5 waits, and takes the room freed by 0.
+	ASSERT_TRUE(waitFor(0, 1));
+	sink->Step();
+	// 6 and 7 are dropped, and 8 waits for room.
+	ASSERT_TRUE(waitFor(2, 1));
+	sink->Step();
+	ASSERT_TRUE(waitFor(4, 0));
+	producer.join();
+	sink->Unblock();
+
+	EXPECT_EQ(sink->Dropped(), 4);
+	EXPECT_THAT(
+	    sink->WaitLines(8),
+	    ElementsAre(
+	        EndsWith("INFO 0"),
+	        EndsWith("INFO 1"),
+	        EndsWith("INFO 2"),
+	        EndsWith("INFO 3"),
+	        EndsWith("INFO 4"),
+	        EndsWith("INFO 5"),
+	        EndsWith("INFO 8"),
+	        EndsWith("WARN \"records dropped\" dropped=4")
+	    )
+	);
+}
+
+TEST_F(AsyncSinkTest, Batching) {
+	static_assert(BatchLogger<CollectingSink<Async, true>>);
+	static_assert(!BatchLogger<CollectingSink<Async, false>>);
+
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithQueueCapacity(8)(baseConfig);
+	WithBatchLimits(3, 1024)(baseConfig);
+	auto sink = std::make_shared<CollectingSink<Async, true>>(baseConfig);
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 7);
+	sink->Unblock();
+
+	EXPECT_THAT(
+	    sink->WaitLines(8),
+	    ElementsAre(
+	        EndsWith("INFO 0"),
+	        EndsWith("INFO 1"),
+	        EndsWith("INFO 2"),
+	        EndsWith("INFO 3"),
+	        EndsWith("INFO 4"),
+	        EndsWith("INFO 5"),
+	        EndsWith("INFO 6"),
+	        EndsWith("INFO 7")
+	    )
+	);
+	EXPECT_THAT(sink->Batches(), ElementsAre(1, 3, 3, 1));
+}
+
+TEST_F(AsyncSinkTest, BatchingBytesLimit) {
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithBatchLimits(256, 1)(baseConfig);
+	auto sink = std::make_shared<CollectingSink<AsyncMtSafe, true>>(baseConfig);
+	Logger<0> logger(sink);
+
+	fill(*sink, logger, 3);
+	sink->Unblock();
+
+	EXPECT_THAT(sink->WaitLines(4), ::testing::SizeIs(4));
+	EXPECT_THAT(sink->Batches(), ElementsAre(1, 1, 1, 1));
+}
+
+TEST_F(AsyncSinkTest, BatchingFailures) {
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithBatchLimits(2, 1024)(baseConfig);
+	auto sink = std::make_shared<CollectingSink<Async, true>>(baseConfig);
+	Logger<0> logger(sink);
+
+	sink->Fail();
+	for (int i = 0; i < 3; ++i) {
+		logger.Info(std::to_string(i));
+	}
+	sink->Flush().wait();
+
+	// the lost records are reported as dropped ones, in one or more reports.
+	EXPECT_EQ(sink->Dropped(), 3);
+	EXPECT_THAT(
+	    sink->WaitLines(1),
+	    ::testing::Each(::testing::HasSubstr("WARN \"records dropped\""))
+	);
+}
+
+// Formats records as their raw timestamp followed by RecordToRawText(), and
+// counts the formatting calls overlapping another one. Async sinks only format
+// their records on their consumer, which must be unique.
+struct ConsumerCounter {
+	inline static std::atomic<int> active{0};
+	inline static std::atomic<int> overlaps{0};
+
+	static void Reset() {
+		active   = 0;
+		overlaps = 0;
+	}
+
+	static void Format(const slog::Record &record, Buffer &buffer) {
+		if (active.fetch_add(1) > 0) {
+			overlaps.fetch_add(1);
+		}
+		buffer += std::to_string(record.timestamp.time_since_epoch().count());
+		buffer += ' ';
+		RecordToRawText(record, buffer);
+		// widens the window for another consumer.
+		std::this_thread::yield();
+		active.fetch_sub(1);
+	}
+};
+
+// A record written by a sink formatting with ConsumerCounter::Format, logged
+// with the message "<producer>-<index>".
+struct WrittenRecord {
+	int64_t timestamp;
+	size_t  producer;
+	size_t  index;
+
+	static WrittenRecord Parse(const std::string &line) {
+		const auto message = line.substr(line.rfind(' ') + 1);
+		const auto dash    = message.find('-');
+		return {
+		    std::stoll(line.substr(0, line.find(' '))),
+		    std::stoul(message.substr(0, dash)),
+		    std::stoul(message.substr(dash + 1)),
+		};
+	}
+};
+
+class AsyncSinkStressTest : public AsyncSinkTest {
+protected:
+	constexpr static size_t Producers = 4;
+	constexpr static size_t Count     = 2000;
+
+	void SetUp() override {
+		// several pool threads may be handed drain jobs of the same sink.
+		threadPool.SetSize(4);
+		ConsumerCounter::Reset();
+	}
+
+	// The message parsed by WrittenRecord::Parse().
+	static std::string message(size_t producer, size_t index) {
+		return std::to_string(producer) + "-" + std::to_string(index);
+	}
+
+	static BaseSinkConfig stressConfig() {
+		auto baseConfig = config(OverflowPolicy::Block);
+		WithQueueCapacity(256)(baseConfig);
+		WithBatchLimits(16, 1024)(baseConfig);
+		return baseConfig;
+	}
+
+	// Logs Count records from each of Producers threads, pausing now and then
+	// so that the consumer goes idle and is woken up again, and checks that
+	// they are all written, by a single consumer, in the order of each
+	// producer.
+	template <typename Sink> static void check(const BaseSinkConfig &config) {
+		auto sink = std::make_shared<Sink>(config, &ConsumerCounter::Format);
+		Logger<0> logger(sink);
+		{
+			std::vector<std::jthread> producers;
+			for (size_t p = 0; p < Producers; ++p) {
+				producers.emplace_back([&logger, p]() {
+					for (size_t i = 0; i < Count; ++i) {
+						logger.Info(message(p, i));
+						if (i % 4 == 0) {
+							std::this_thread::sleep_for(
+							    std::chrono::microseconds(10 * (p + 1))
+							);
+						}
+					}
+				});
+			}
+		}
+		ASSERT_EQ(
+		    sink->Flush().wait_for(std::chrono::seconds(10)),
+		    std::future_status::ready
+		);
+
+		const auto lines = sink->WaitLines(0);
+		EXPECT_EQ(lines.size(), Producers * Count);
+		EXPECT_EQ(sink->Dropped(), 0);
+		EXPECT_EQ(ConsumerCounter::overlaps.load(), 0);
+		std::vector<size_t> next(Producers, 0);
+		for (const auto &line : lines) {
+			const auto record = WrittenRecord::Parse(line);
+			ASSERT_LT(record.producer, Producers);
+			ASSERT_EQ(record.index, next[record.producer]) << line;
+			++next[record.producer];
+		}
+	}
+};
+
+TEST_F(AsyncSinkStressTest, SharedPool) {
+	check<CollectingSink<Async, true>>(stressConfig());
+	ConsumerCounter::Reset();
+	check<CollectingSink<AsyncMtSafe, true>>(stressConfig());
+}
+
+TEST_F(AsyncSinkStressTest, DedicatedWriter) {
+	auto baseConfig = stressConfig();
+	WithDedicatedWriter()(baseConfig);
+	check<CollectingSink<Async, true>>(baseConfig);
+	ConsumerCounter::Reset();
+	check<CollectingSink<AsyncMtSafe, true>>(baseConfig);
+}
+
+TEST_F(AsyncSinkStressTest, PerThreadQueues) {
+	auto baseConfig = stressConfig();
+	WithPerThreadQueues()(baseConfig);
+	check<CollectingSink<Async, true>>(baseConfig);
+	ConsumerCounter::Reset();
+	check<CollectingSink<AsyncMtSafe, true>>(baseConfig);
+}
+
+TEST_F(AsyncSinkStressTest, PerThreadQueuesMergeByTimestamp) {
+	auto baseConfig = config(OverflowPolicy::Block);
+	WithPerThreadQueues()(baseConfig);
+	WithQueueCapacity(64)(baseConfig);
+	auto sink = std::make_shared<CollectingSink<Async>>(
+	    baseConfig,
+	    &ConsumerCounter::Format
+	);
+	Logger<0> logger(sink);
+
+	// every record is queued before the consumer merges the lanes.
+	sink->Block();
+	logger.Info(message(Producers, 0));
+	sink->WaitConsuming();
+	{
+		std::vector<std::jthread> producers;
+		for (size_t p = 0; p < Producers; ++p) {
+			producers.emplace_back([&logger, p]() {
+				for (size_t i = 0; i < 64; ++i) {
+					logger.Info(message(p, i));
+				}
+			});
+		}
+	}
+	sink->Unblock();
+
+	const auto lines = sink->WaitLines(Producers * 64 + 1);
+	ASSERT_EQ(lines.size(), Producers * 64 + 1);
+	EXPECT_EQ(sink->Dropped(), 0);
+	EXPECT_TRUE(std::is_sorted(
+	    lines.begin() + 1,
+	    lines.end(),
+	    [](const std::string &a, const std::string &b) {
+		    return WrittenRecord::Parse(a).timestamp <
+		           WrittenRecord::Parse(b).timestamp;
+	    }
+	));
+}
+
+TEST_F(AsyncSinkStressTest, PerThreadQueuesDropOldest) {
+	auto baseConfig = config(OverflowPolicy::DropOldest);
+	WithPerThreadQueues()(baseConfig);
+	auto sink = std::make_shared<CollectingSink<Async>>(
+	    baseConfig,
+	    &ConsumerCounter::Format
+	);
+	Logger<0> logger(sink);
+
+	// each producer overflows its own lane of 4 records, and evicts its own
+	// oldest ones.
+	sink->Block();
+	logger.Info(message(Producers, 0));
+	sink->WaitConsuming();
+	{
+		std::vector<std::jthread> producers;
+		for (size_t p = 0; p < Producers; ++p) {
+			producers.emplace_back([&logger, p]() {
+				for (size_t i = 0; i < 10; ++i) {
+					logger.Info(message(p, i));
+				}
+			});
+		}
+	}
+	EXPECT_EQ(sink->Dropped(), Producers * 6);
+	sink->Unblock();
+
+	const auto lines = sink->WaitLines(Producers * 4 + 2);
+	ASSERT_EQ(lines.size(), Producers * 4 + 2);
+	const auto dropped = std::to_string(Producers * 6);
+	EXPECT_THAT(
+	    lines.back(),
+	    EndsWith("WARN \"records dropped\" dropped=" + dropped)
+	);
+	std::map<size_t, std::vector<size_t>> kept;
+	for (size_t i = 1; i + 1 < lines.size(); ++i) {
+		const auto record = WrittenRecord::Parse(lines[i]);
+		kept[record.producer].push_back(record.index);
+	}
+	for (size_t p = 0; p < Producers; ++p) {
+		EXPECT_THAT(kept[p], ElementsAre(6, 7, 8, 9));
+	}
+}
+
+// A synchronous sink logging to another one while it writes a record.
+class ForwardingSink : public Sink<ForwardingSink, Unsafe> {
+public:
+	inline ForwardingSink(const BaseSinkConfig &config, Logger<0> forward)
+	    : Sink<ForwardingSink, Unsafe>(config, &RecordToRawText)
+	    , d_forward{std::move(forward)} {}
+
+	void Log(const Buffer &buffer) {
+		d_forward.Info("forwarded");
+		lines.push_back(buffer);
+	}
+
+	std::vector<std::string> lines;
+
+private:
+	Logger<0> d_forward;
+};
+
+TEST(SyncSinkTest, NestedLogsUseTheirOwnBuffer) {
+	BaseSinkConfig config;
+	FromLevel(Level::Trace)(config);
+	auto collecting = std::make_shared<CollectingSink<Unsafe>>(config);
+	auto forwarding =
+	    std::make_shared<ForwardingSink>(config, Logger<0>(collecting));
+	Logger<0> logger(forwarding);
+
+	logger.Info("0");
+	EXPECT_THAT(forwarding->lines, ElementsAre(EndsWith("INFO 0")));
+	EXPECT_THAT(
+	    collecting->WaitLines(1),
+	    ElementsAre(EndsWith("INFO forwarded"))
+	);
+}
+
+} // namespace details
+} // namespace slog
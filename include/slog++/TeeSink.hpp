@@ -59,6 +59,14 @@ public:
 		}
 	}
 
+	using slog::Sink::Flush;
+
+	void Flush(std::shared_ptr<FlushBarrier> barrier) override {
+		for (auto &sink : d_sinks) {
+			sink->Flush(barrier);
+		}
+	}
+
 private:
 	using UniquePtr = std::unique_ptr<const slog::Record>;
 	using SharedPtr = std::shared_ptr<const slog::Record>;
@@ -133,4 +133,29 @@ TEST_F(TeeSinkTest, PropagateFromAndSet) {
 	multi->Set(Level::Debug, true);
 }
 
+TEST_F(TeeSinkTest, FlushesAllSinks) {
+	EXPECT_CALL(*sink1, AllocateOnStack()).WillOnce(Return(true));
+	EXPECT_CALL(*sink2, AllocateOnStack()).WillOnce(Return(true));
+
+	std::shared_ptr<FlushBarrier> held;
+	EXPECT_CALL(*sink1, Flush(_)).Times(1);
+	EXPECT_CALL(*sink2, Flush(_))
+	    .WillOnce([&held](std::shared_ptr<FlushBarrier> barrier) {
+		    held = std::move(barrier);
+	    });
+
+	auto multi = TeeSink(sink1, sink2);
+
+	auto done = multi->Flush();
+	EXPECT_EQ(
+	    done.wait_for(std::chrono::seconds(0)),
+	    std::future_status::timeout
+	);
+	held.reset();
+	EXPECT_EQ(
+	    done.wait_for(std::chrono::seconds(0)),
+	    std::future_status::ready
+	);
+}
+
 } // namespace slog
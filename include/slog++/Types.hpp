@@ -1,16 +1,27 @@
 #pragma once
 
+#include "details/StaticString.hpp"
 #include "utils/ContainerReference.hpp"
 
 #include <chrono>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <variant>
 
+#if defined(SLOGPP_COMPACT_VALUE) && !defined(SLOGPP_SMALLER_STRING)
+// the compact value needs strings of at most 16 bytes.
+#define SLOGPP_SMALLER_STRING
+#endif
+
 #ifdef SLOGPP_SMALLER_STRING
 #include "details/String.hpp"
 #endif
 
+#ifdef SLOGPP_COMPACT_VALUE
+#include "details/CompactValue.hpp"
+#endif
+
 namespace slog {
 
 struct Attribute;
@@ -42,11 +53,35 @@ protected:
 	Group &operator=(Group &&)      = default;
 };
 
+// A string value only referenced by a record allocated on the stack. See
+// slog::StringView().
+struct StringRef {
+	inline explicit StringRef(std::string_view view) noexcept
+	    : view{view} {}
+
+	bool operator==(const StringRef &) const noexcept = default;
+
+	std::string_view view;
+};
+
 } // namespace details
 
 typedef std::shared_ptr<details::Group> GroupPtr;
 using Buffer = std::string;
 
+/**
+ * Marks a string literal, to use as a key or a string value, as having static
+ * storage: with SLOGPP_SMALLER_STRING, it is then referenced instead of copied.
+ * Being consteval, it rejects arrays which are automatic variables.
+ */
+template <size_t N>
+consteval details::StaticString Literal(const char (&literal)[N]) noexcept {
+	if (literal[N - 1] != '\0') {
+		throw "slog::Literal() needs a null terminated string";
+	}
+	return details::StaticString{literal, N - 1};
+}
+
 #ifdef SLOGPP_SMALLER_STRING
 using StringType = details::String;
 #define SLOGPP_appendToBuffer(b, str)                                          \
@@ -61,6 +96,25 @@ using StringType = std::string;
 	} while (0)
 #endif
 
+#ifdef SLOGPP_COMPACT_VALUE
+using Value = details::CompactValue<
+    std::monostate,
+    bool,
+    int64_t,
+    double,
+    StringType,
+    DurationT,
+    TimeT,
+    GroupPtr,
+    void *,
+    details::StringRef>;
+
+static_assert(sizeof(Value) == 24, "a compact Value should fit in 24 bytes");
+
+// a compact Value is not a literal type, so that the non-template functions
+// returning an Attribute cannot be constexpr.
+#define SLOGPP_ATTRIBUTE_CONSTEXPR inline
+#else
 using Value = std::variant<
     std::monostate,
     bool,
@@ -70,7 +124,25 @@ using Value = std::variant<
     DurationT,
     TimeT,
     GroupPtr,
-    void *>;
+    void *,
+    details::StringRef>;
+
+#define SLOGPP_ATTRIBUTE_CONSTEXPR constexpr
+#endif
+
+namespace details {
+inline std::string_view viewOf(const StringType &value) noexcept {
+#ifdef SLOGPP_SMALLER_STRING
+	return value.string_view();
+#else
+	return value;
+#endif
+}
+
+inline std::string_view viewOf(const StringRef &value) noexcept {
+	return value.view;
+}
+} // namespace details
 
 class Record;
 
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <new>
+
+namespace slog {
+namespace details {
+
+// Per-thread cache of the small blocks freed by a thread, such as the groups
+// built by Group(). A group logged on the stack path is built and destroyed by
+// the same thread during the log call, so that it reuses the block of the
+// previous one, without calling the global allocator nor touching an atomic.
+//
+// Blocks are sorted in classes of Granularity bytes, and the blocks larger
+// than the last class are not cached. A block freed by another thread, such
+// as the consumer of an asynchronous sink, goes to the cache of that thread.
+class BlockCache {
+public:
+	constexpr static size_t Granularity = 64;
+	constexpr static size_t Classes     = 16;
+	// the number of free blocks kept per class and per thread.
+	constexpr static size_t MaxBlocks   = 32;
+
+	inline static void *Allocate(size_t size) {
+		const size_t index = classOf(size);
+		if (index >= Classes) {
+			return ::operator new(size);
+		}
+		auto *lists = freeLists();
+		if (lists != nullptr && (*lists)[index].head != nullptr) {
+			auto &list = (*lists)[index];
+			auto *free = list.head;
+			list.head  = free->next;
+			--list.size;
+			return free;
+		}
+		return ::operator new((index + 1) * Granularity);
+	}
+
+	// size must be the one given to Allocate().
+	inline static void Deallocate(void *ptr, size_t size) noexcept {
+		const size_t index = classOf(size);
+		auto        *lists = index < Classes ? freeLists() : nullptr;
+		if (lists == nullptr || (*lists)[index].size >= MaxBlocks) {
+			::operator delete(ptr);
+			return;
+		}
+		auto &list = (*lists)[index];
+		list.head  = new (ptr) FreeBlock{list.head};
+		++list.size;
+	}
+
+private:
+	struct FreeBlock {
+		FreeBlock *next;
+	};
+
+	struct FreeList {
+		FreeBlock *head = nullptr;
+		size_t     size = 0;
+	};
+
+	using FreeLists = std::array<FreeList, Classes>;
+
+	inline static size_t classOf(size_t size) noexcept {
+		return size == 0 ? 0 : (size - 1) / Granularity;
+	}
+
+	// Returns nullptr once the thread's lists are destroyed, as static
+	// objects may still free blocks after that.
+	inline static FreeLists *freeLists() noexcept {
+		struct Holder {
+			FreeLists lists;
+			bool     &destroyed;
+
+			inline ~Holder() {
+				for (auto &list : lists) {
+					while (list.head != nullptr) {
+						auto *free = list.head;
+						list.head  = free->next;
+						::operator delete(free);
+					}
+				}
+				destroyed = true;
+			}
+		};
+
+		// trivially destructible, it remains valid after holder.
+		thread_local bool destroyed = false;
+		if (destroyed) {
+			return nullptr;
+		}
+		thread_local Holder holder{{}, destroyed};
+		return &holder.lists;
+	}
+};
+
+// Allocates from BlockCache, for std::allocate_shared().
+template <typename T> struct BlockAllocator {
+	static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+	using value_type = T;
+
+	BlockAllocator() noexcept = default;
+
+	template <typename U>
+	inline BlockAllocator(const BlockAllocator<U> &) noexcept {}
+
+	inline T *allocate(size_t n) {
+		return static_cast<T *>(BlockCache::Allocate(n * sizeof(T)));
+	}
+
+	inline void deallocate(T *ptr, size_t n) noexcept {
+		BlockCache::Deallocate(ptr, n * sizeof(T));
+	}
+
+	template <typename U>
+	inline bool operator==(const BlockAllocator<U> &) const noexcept {
+		return true;
+	}
+};
+
+} // namespace details
+} // namespace slog
@@ -0,0 +1,47 @@
+#include "BlockCache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace slog {
+namespace details {
+
+TEST(BlockCache, ReusesFreedBlocks) {
+	std::thread([]() {
+		void *first = BlockCache::Allocate(100);
+		BlockCache::Deallocate(first, 100);
+		// same size class.
+		void *second = BlockCache::Allocate(120);
+		EXPECT_EQ(second, first);
+		void *other = BlockCache::Allocate(200);
+		EXPECT_NE(other, first);
+		BlockCache::Deallocate(second, 120);
+		BlockCache::Deallocate(other, 200);
+	}).join();
+}
+
+TEST(BlockCache, BoundsCachedBlocks) {
+	std::thread([]() {
+		constexpr size_t size = BlockCache::Granularity;
+
+		std::vector<void *> blocks;
+		for (size_t i = 0; i <= BlockCache::MaxBlocks; ++i) {
+			blocks.push_back(BlockCache::Allocate(size));
+		}
+		for (auto *block : blocks) {
+			BlockCache::Deallocate(block, size);
+		}
+		// the last block was given back to the global allocator.
+		for (size_t i = BlockCache::MaxBlocks; i > 0; --i) {
+			EXPECT_EQ(BlockCache::Allocate(size), blocks[i - 1]);
+		}
+		for (size_t i = 0; i < BlockCache::MaxBlocks; ++i) {
+			BlockCache::Deallocate(blocks[i], size);
+		}
+	}).join();
+}
+
+} // namespace details
+} // namespace slog
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace slog {
+namespace details {
+
+// A tagged union of Types, used as Value when SLOGPP_COMPACT_VALUE is defined.
+// It stores its alternative inline, followed by a one byte index, so that a
+// 16 bytes payload gives a 24 bytes value.
+//
+// It follows std::variant where the library relies on it: the converting
+// constructor selects the same alternative, and index(), get(), get_if(),
+// holds_alternative() and visit() are found through ADL. Unlike std::variant,
+// it is never valueless, and the trivially copyable alternatives are copied
+// with a plain memcpy, without dispatching on the index.
+template <typename... Types> class CompactValue {
+	static_assert(
+	    sizeof...(Types) >= 1 && sizeof...(Types) <= UINT8_MAX,
+	    "the index is stored in a single byte"
+	);
+
+	constexpr static bool Trivial[] = {std::is_trivially_copyable_v<Types>...};
+	constexpr static bool NothrowMovable =
+	    (std::is_nothrow_move_constructible_v<Types> && ...);
+
+	// Selects the alternative as std::variant's converting constructor: T must
+	// convert to it without narrowing, and only a bool converts to bool.
+	template <size_t I, typename Ti> struct Candidate {
+		template <typename T>
+		    requires requires(T &&t) {
+			    std::type_identity_t<Ti[]>{std::forward<T>(t)};
+		    } && (!std::is_same_v<std::remove_cv_t<Ti>, bool> ||
+		          std::is_same_v<std::remove_cvref_t<T>, bool>)
+		static std::integral_constant<size_t, I> Select(Ti);
+	};
+
+	template <typename Sequence> struct CandidateSet;
+
+	template <size_t... I>
+	struct CandidateSet<std::index_sequence<I...>> : Candidate<I, Types>... {
+		using Candidate<I, Types>::Select...;
+	};
+
+	using Candidates = CandidateSet<std::index_sequence_for<Types...>>;
+
+public:
+	template <size_t I>
+	using Alternative = std::tuple_element_t<I, std::tuple<Types...>>;
+
+	static_assert(
+	    std::is_trivially_copyable_v<Alternative<0>> &&
+	        std::is_nothrow_default_constructible_v<Alternative<0>>,
+	    "the first alternative is the fallback state"
+	);
+
+	template <typename T> constexpr static size_t IndexOf = [] {
+		constexpr bool matches[] = {std::is_same_v<T, Types>...};
+		size_t         index     = 0;
+		while (index < sizeof...(Types) && matches[index] == false) {
+			++index;
+		}
+		return index;
+	}();
+
+	inline CompactValue() noexcept
+	    : CompactValue{std::in_place_index<0>} {}
+
+	template <size_t I, typename... Args>
+	inline explicit CompactValue(std::in_place_index_t<I>, Args &&...args)
+	    : d_index{uint8_t(I)} {
+		new (d_storage) Alternative<I>(std::forward<Args>(args)...);
+	}
+
+	template <typename T, typename... Args>
+	inline explicit CompactValue(std::in_place_type_t<T>, Args &&...args)
+	    : CompactValue{
+	          std::in_place_index<IndexOf<T>>,
+	          std::forward<Args>(args)...,
+	      } {}
+
+	template <typename T>
+	    requires(!std::is_same_v<std::remove_cvref_t<T>, CompactValue>) &&
+	            requires { Candidates::template Select<T>(std::declval<T>()); }
+	inline CompactValue(T &&value)
+	    : CompactValue{
+	          std::in_place_index<decltype(Candidates::template Select<T>(
+	              std::declval<T>()
+	          ))::value>,
+	          std::forward<T>(value),
+	      } {}
+
+	inline CompactValue(const CompactValue &other)
+	    : d_index{other.d_index} {
+		if (Trivial[d_index]) {
+			std::memcpy(d_storage, other.d_storage, sizeof(d_storage));
+			return;
+		}
+		other.Visit([this](const auto &value) {
+			using T = std::remove_cvref_t<decltype(value)>;
+			new (d_storage) T(value);
+		});
+	}
+
+	inline CompactValue(CompactValue &&other) noexcept(NothrowMovable)
+	    : d_index{other.d_index} {
+		moveFrom(other);
+	}
+
+	inline ~CompactValue() {
+		destroy();
+	}
+
+	inline CompactValue &operator=(const CompactValue &other) {
+		if (this != &other) {
+			*this = CompactValue{other};
+		}
+		return *this;
+	}
+
+	inline CompactValue &operator=(CompactValue &&other
+	) noexcept(NothrowMovable) {
+		if (this != &other) {
+			reset();
+			d_index = other.d_index;
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	template <typename T>
+	    requires(!std::is_same_v<std::remove_cvref_t<T>, CompactValue>) &&
+	            std::is_constructible_v<CompactValue, T>
+	inline CompactValue &operator=(T &&value) {
+		return *this = CompactValue{std::forward<T>(value)};
+	}
+
+	inline constexpr size_t index() const noexcept {
+		return d_index;
+	}
+
+	inline bool operator==(const CompactValue &other) const {
+		if (d_index != other.d_index) {
+			return false;
+		}
+		return Visit([&other](const auto &value) {
+			using T = std::remove_cvref_t<decltype(value)>;
+			return value == other.template unchecked<IndexOf<T>>();
+		});
+	}
+
+	// Calls visitor with the held alternative.
+	template <typename Visitor>
+	inline decltype(auto) Visit(Visitor &&visitor) const {
+		return dispatch(
+		    std::forward<Visitor>(visitor),
+		    *this,
+		    std::index_sequence_for<Types...>{}
+		);
+	}
+
+	template <typename Visitor> inline decltype(auto) Visit(Visitor &&visitor) {
+		return dispatch(
+		    std::forward<Visitor>(visitor),
+		    *this,
+		    std::index_sequence_for<Types...>{}
+		);
+	}
+
+	template <typename T>
+	friend constexpr bool holds_alternative(const CompactValue &value
+	) noexcept {
+		return value.d_index == IndexOf<T>;
+	}
+
+	template <typename T>
+	friend inline const T &get(const CompactValue &value) {
+		if (value.d_index != IndexOf<T>) {
+			throw std::bad_variant_access{};
+		}
+		return value.template unchecked<IndexOf<T>>();
+	}
+
+	template <typename T> friend inline T &get(CompactValue &value) {
+		if (value.d_index != IndexOf<T>) {
+			throw std::bad_variant_access{};
+		}
+		return value.template unchecked<IndexOf<T>>();
+	}
+
+	template <typename T>
+	friend inline const T *get_if(const CompactValue *value) noexcept {
+		if (value == nullptr || value->d_index != IndexOf<T>) {
+			return nullptr;
+		}
+		return &value->template unchecked<IndexOf<T>>();
+	}
+
+	template <typename Visitor>
+	friend inline decltype(auto)
+	visit(Visitor &&visitor, const CompactValue &value) {
+		return value.Visit(std::forward<Visitor>(visitor));
+	}
+
+	template <typename Visitor>
+	friend inline decltype(auto) visit(Visitor &&visitor, CompactValue &value) {
+		return value.Visit(std::forward<Visitor>(visitor));
+	}
+
+private:
+	template <size_t I> inline Alternative<I> &unchecked() noexcept {
+		return *std::launder(reinterpret_cast<Alternative<I> *>(d_storage));
+	}
+
+	template <size_t I>
+	inline const Alternative<I> &unchecked() const noexcept {
+		return *std::launder(
+		    reinterpret_cast<const Alternative<I> *>(d_storage)
+		);
+	}
+
+	template <typename Visitor, typename Self, size_t... I>
+	inline static decltype(auto)
+	dispatch(Visitor &&visitor, Self &self, std::index_sequence<I...>) {
+		using Result = std::invoke_result_t<
+		    Visitor,
+		    decltype(self.template unchecked<0>())>;
+		using Function = Result (*)(Visitor &&, Self &);
+
+		constexpr static Function table[] = {
+		    [](Visitor &&visitor, Self &self) -> Result {
+			    return std::forward<Visitor>(visitor)(
+			        self.template unchecked<I>()
+			    );
+		    }...,
+		};
+		return table[self.d_index](std::forward<Visitor>(visitor), self);
+	}
+
+	// the index must already be set to the one of other.
+	inline void moveFrom(CompactValue &other) noexcept(NothrowMovable) {
+		if (Trivial[d_index]) {
+			std::memcpy(d_storage, other.d_storage, sizeof(d_storage));
+			return;
+		}
+		// falls back to the first alternative if the move throws.
+		const auto index = d_index;
+		d_index          = 0;
+		other.Visit([this](auto &value) {
+			using T = std::remove_cvref_t<decltype(value)>;
+			new (d_storage) T(std::move(value));
+		});
+		d_index = index;
+	}
+
+	inline void destroy() noexcept {
+		if (Trivial[d_index]) {
+			return;
+		}
+		Visit([](auto &value) {
+			using T = std::remove_cvref_t<decltype(value)>;
+			value.~T();
+		});
+	}
+
+	// Destroys the held alternative, and holds the first one instead.
+	inline void reset() noexcept {
+		destroy();
+		d_index = 0;
+		new (d_storage) Alternative<0>();
+	}
+
+	alignas(Types...) std::byte d_storage[std::max({sizeof(Types)...})];
+	uint8_t d_index;
+};
+
+} // namespace details
+} // namespace slog
+
+// lets code written against std::variant inspect the alternatives.
+template <typename... Types>
+struct std::variant_size<slog::details::CompactValue<Types...>>
+    : std::integral_constant<size_t, sizeof...(Types)> {};
+
+template <size_t I, typename... Types>
+struct std::variant_alternative<I, slog::details::CompactValue<Types...>> {
+	using type =
+	    typename slog::details::CompactValue<Types...>::template Alternative<I>;
+};
@@ -0,0 +1,100 @@
+#include "CompactValue.hpp"
+#include "StaticString.hpp"
+#include "String.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace slog {
+namespace details {
+
+using TestValue = CompactValue<
+    std::monostate,
+    bool,
+    int64_t,
+    double,
+    String,
+    std::chrono::nanoseconds,
+    std::shared_ptr<int>,
+    void *>;
+
+static_assert(sizeof(TestValue) == 24);
+
+TEST(CompactValue, SelectsAlternativesAsVariant) {
+	EXPECT_EQ(TestValue{}.index(), 0);
+	EXPECT_EQ(TestValue{true}.index(), 1);
+	EXPECT_EQ(TestValue{42}.index(), 2);
+	EXPECT_EQ(TestValue{uint8_t(42)}.index(), 2);
+	EXPECT_EQ(TestValue{1.5}.index(), 3);
+	EXPECT_EQ((TestValue{StaticString{"string", 6}}.index()), 4);
+	EXPECT_EQ(TestValue{std::string("string")}.index(), 4);
+	EXPECT_EQ(TestValue{std::chrono::nanoseconds(1)}.index(), 5);
+	EXPECT_EQ(TestValue{std::make_shared<int>(1)}.index(), 6);
+	int i;
+	EXPECT_EQ(TestValue{static_cast<void *>(&i)}.index(), 7);
+
+	EXPECT_TRUE(holds_alternative<int64_t>(TestValue{42}));
+	EXPECT_EQ(get<int64_t>(TestValue{42}), 42);
+	EXPECT_STREQ(
+	    get<String>(TestValue{std::string("string")}).c_str(),
+	    "string"
+	);
+	EXPECT_THROW(get<bool>(TestValue{42}), std::bad_variant_access);
+	TestValue value{1.5};
+	EXPECT_EQ(get_if<bool>(&value), nullptr);
+	ASSERT_NE(get_if<double>(&value), nullptr);
+	EXPECT_EQ(*get_if<double>(&value), 1.5);
+}
+
+TEST(CompactValue, CopiesAndMoves) {
+	const std::string large(64, 'a');
+	auto              shared = std::make_shared<int>(1);
+
+	TestValue string{large};
+	TestValue copy{string};
+	EXPECT_EQ(get<String>(copy).string_view(), large);
+	TestValue moved{std::move(copy)};
+	EXPECT_EQ(get<String>(moved).string_view(), large);
+
+	TestValue group{shared};
+	{
+		TestValue other{group};
+		EXPECT_EQ(shared.use_count(), 3);
+		other = 42;
+		EXPECT_EQ(shared.use_count(), 2);
+		other = group;
+		EXPECT_EQ(shared.use_count(), 3);
+		other = std::move(moved);
+		EXPECT_EQ(shared.use_count(), 2);
+		EXPECT_EQ(get<String>(other).string_view(), large);
+	}
+	group = TestValue{};
+	EXPECT_EQ(shared.use_count(), 1);
+
+	EXPECT_EQ(TestValue{42}, TestValue{42});
+	EXPECT_FALSE(TestValue{42} == TestValue{43});
+	EXPECT_FALSE(TestValue{42} == TestValue{42.0});
+	EXPECT_EQ(TestValue{large}, TestValue{large});
+}
+
+TEST(CompactValue, Visits) {
+	auto name = [](const auto &value) -> std::string {
+		using T = std::decay_t<decltype(value)>;
+		if constexpr (std::is_same_v<T, int64_t>) {
+			return "int " + std::to_string(value);
+		} else if constexpr (std::is_same_v<T, String>) {
+			return "string " + std::string(value.string_view());
+		} else {
+			return "other";
+		}
+	};
+	EXPECT_EQ(visit(name, TestValue{42}), "int 42");
+	EXPECT_EQ(visit(name, TestValue{std::string("foo")}), "string foo");
+	EXPECT_EQ(visit(name, TestValue{true}), "other");
+}
+
+} // namespace details
+} // namespace slog
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../Attribute.hpp"
+#include "../Types.hpp"
+
+#include <array>
+#include <memory>
+#include <mutex>
+
+namespace slog {
+namespace details {
+
+class Context;
+
+using ContextPtr = std::shared_ptr<const Context>;
+
+// The context of a logger derived with With(): the leading attributes of every
+// record it logs. It is an immutable chain of blocks, each holding the
+// attributes added by one With() call and sharing the block of its parent, so
+// that deriving a logger only copies the new attributes.
+//
+// The records reference it instead of copying its attributes, and the
+// formatters append the context encoded once per output format instead of
+// encoding it again.
+class Context {
+public:
+	enum class Format {
+		JSON = 0,
+		Text,
+	};
+
+	// non-copyable non-movable, as it is shared by the loggers and records.
+	Context(const Context &)            = delete;
+	Context(Context &&)                 = delete;
+	Context &operator=(const Context &) = delete;
+	Context &operator=(Context &&)      = delete;
+
+	// Returns the number of leading record attributes held by the chain.
+	inline size_t Size() const noexcept {
+		return d_offset + d_attributes.size();
+	}
+
+	// Calls f on each attribute of the chain, from the first one.
+	template <typename F> inline void ForEach(F &&f) const {
+		if (d_parent) {
+			d_parent->ForEach(f);
+		}
+		for (const auto &attribute : d_attributes) {
+			f(attribute);
+		}
+	}
+
+	// Returns the chain encoded in format. Each block is rendered on first use
+	// by calling render(attribute, buffer) on its attributes, after the
+	// encoding of its parent.
+	template <typename Render>
+	inline const Buffer &Encoded(Format format, Render &&render) const {
+		auto &fragment = d_fragments[size_t(format)];
+		std::call_once(fragment.once, [&] {
+			if (d_parent) {
+				fragment.encoded = d_parent->Encoded(format, render);
+			}
+			for (const auto &attribute : d_attributes) {
+				render(attribute, fragment.encoded);
+			}
+		});
+		return fragment.encoded;
+	}
+
+protected:
+	// offset is the number of attributes of the parent chain.
+	inline Context(ContextPtr parent, size_t offset) noexcept
+	    : d_parent{std::move(parent)}
+	    , d_offset{offset} {}
+
+	utils::ContainerReference<Attribute> d_attributes;
+
+private:
+	struct Fragment {
+		std::once_flag once;
+		Buffer         encoded;
+	};
+
+	ContextPtr                      d_parent;
+	size_t                          d_offset;
+	mutable std::array<Fragment, 2> d_fragments;
+};
+
+template <size_t N> class ContextBlock : public Context {
+public:
+	template <typename... Attributes>
+	inline ContextBlock(
+	    ContextPtr parent, size_t offset, Attributes &&...attributes
+	)
+	    : Context{std::move(parent), offset}
+	    , d_data{std::forward<Attributes>(attributes)...} {
+		if constexpr (N > 0) {
+			this->d_attributes = utils::ContainerReference<Attribute>(d_data);
+		}
+	}
+
+private:
+	details::Array<Attribute, N> d_data;
+};
+
+} // namespace details
+} // namespace slog
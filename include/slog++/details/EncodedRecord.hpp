@@ -0,0 +1,301 @@
+#pragma once
+
+#include "../Attribute.hpp"
+#include "../Record.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace slog {
+namespace details {
+
+// A Record serialized in a flat byte buffer. It only holds raw copies of the
+// timestamp, level, message and attribute values, so encoding a record never
+// formats anything, and never allocates if it fits in InlineCapacity bytes.
+// Larger records are encoded in a heap allocated buffer.
+//
+// The encoding is only meant to be decoded by the same process, values are
+// therefore stored in native byte order. Strings are stored as a uint32_t size
+// followed by their bytes, attribute values as their Value index followed by
+// their payload, and groups as their number of attributes followed by them.
+class EncodedRecord {
+public:
+	static_assert(
+	    std::variant_size_v<Value> == 10 &&
+	        std::is_same_v<std::variant_alternative_t<4, Value>, StringType> &&
+	        std::is_same_v<std::variant_alternative_t<7, Value>, GroupPtr> &&
+	        std::is_same_v<std::variant_alternative_t<8, Value>, void *> &&
+	        std::is_same_v<std::variant_alternative_t<9, Value>, StringRef>,
+	    "decoding relies on the Value alternatives order"
+	);
+
+	constexpr static size_t InlineCapacity = 240;
+
+	inline EncodedRecord() noexcept = default;
+
+	inline explicit EncodedRecord(const slog::Record &record) {
+		Counter counter;
+		encode(record, counter);
+		d_size         = counter.size;
+		std::byte *out = d_inline;
+		if (d_size > InlineCapacity) {
+			d_heap = std::make_unique<std::byte[]>(d_size);
+			out    = d_heap.get();
+		}
+		Writer writer{out};
+		encode(record, writer);
+	}
+
+	inline EncodedRecord(EncodedRecord &&other) noexcept {
+		*this = std::move(other);
+	}
+
+	inline EncodedRecord &operator=(EncodedRecord &&other) noexcept {
+		d_size = other.d_size;
+		d_heap = std::move(other.d_heap);
+		if (d_heap == nullptr) {
+			memcpy(d_inline, other.d_inline, d_size);
+		}
+		other.d_size = 0;
+		return *this;
+	}
+
+	EncodedRecord(const EncodedRecord &)            = delete;
+	EncodedRecord &operator=(const EncodedRecord &) = delete;
+
+	inline bool Empty() const noexcept {
+		return d_size == 0;
+	}
+
+	// Returns true if the record did not fit in InlineCapacity bytes.
+	inline bool Allocated() const noexcept {
+		return d_heap != nullptr;
+	}
+
+	inline size_t Size() const noexcept {
+		return d_size;
+	}
+
+	inline const std::byte *Data() const noexcept {
+		return d_heap ? d_heap.get() : d_inline;
+	}
+
+	inline TimeT Timestamp() const noexcept {
+		if (d_size == 0) {
+			return TimeT{};
+		}
+		int64_t ns;
+		memcpy(&ns, Data(), sizeof(ns));
+		return TimeT{DurationT{ns}};
+	}
+
+private:
+	struct Counter {
+		size_t size = 0;
+
+		template <typename T> inline void put(const T &) noexcept {
+			size += sizeof(T);
+		}
+
+		inline void putString(std::string_view s) noexcept {
+			size += sizeof(uint32_t) + s.size();
+		}
+	};
+
+	struct Writer {
+		std::byte *ptr;
+
+		template <typename T> inline void put(const T &value) noexcept {
+			memcpy(ptr, &value, sizeof(T));
+			ptr += sizeof(T);
+		}
+
+		inline void putString(std::string_view s) noexcept {
+			put(uint32_t(s.size()));
+			memcpy(ptr, s.data(), s.size());
+			ptr += s.size();
+		}
+	};
+
+	inline static std::string_view view(const StringType &s) noexcept {
+		return viewOf(s);
+	}
+
+	template <typename Out>
+	inline static void encode(const slog::Record &record, Out &out) {
+		out.put(int64_t(record.timestamp.time_since_epoch().count()));
+		out.put(record.level);
+		out.putString(view(record.message));
+		// the context is decoded as the leading attributes.
+		out.put(uint32_t(record.AttributeCount()));
+		record.ForEachAttribute([&out](const Attribute &attribute) {
+			encode(attribute, out);
+		});
+	}
+
+	template <typename Out>
+	inline static void
+	encode(const utils::ContainerReference<Attribute> &attributes, Out &out) {
+		out.put(uint32_t(attributes.size()));
+		for (const auto &attribute : attributes) {
+			encode(attribute, out);
+		}
+	}
+
+	template <typename Out>
+	inline static void encode(const Attribute &attribute, Out &out) {
+		out.putString(view(attribute.key));
+		// referenced strings are decoded as owned ones.
+		const bool borrowed = holds_alternative<StringRef>(attribute.value);
+		out.put(uint8_t(borrowed ? 4 : attribute.value.index()));
+		visit(
+		    [&out](const auto &value) { encodeValue(value, out); },
+		    attribute.value
+		);
+	}
+
+	template <typename Out>
+	inline static void encodeValue(const std::monostate &, Out &) {}
+
+	template <typename Out>
+	inline static void encodeValue(const bool &value, Out &out) {
+		out.put(uint8_t(value));
+	}
+
+	template <typename Out>
+	inline static void encodeValue(const int64_t &value, Out &out) {
+		out.put(value);
+	}
+
+	template <typename Out>
+	inline static void encodeValue(const double &value, Out &out) {
+		out.put(value);
+	}
+
+	template <typename Out>
+	inline static void encodeValue(const StringType &value, Out &out) {
+		out.putString(view(value));
+	}
+
+	template <typename Out>
+	inline static void encodeValue(const StringRef &value, Out &out) {
+		out.putString(value.view);
+	}
+
+	template <typename Out>
+	inline static void encodeValue(const DurationT &value, Out &out) {
+		out.put(int64_t(value.count()));
+	}
+
+	template <typename Out>
+	inline static void encodeValue(const TimeT &value, Out &out) {
+		out.put(int64_t(value.time_since_epoch().count()));
+	}
+
+	template <typename Out>
+	inline static void encodeValue(const GroupPtr &value, Out &out) {
+		if (value == nullptr) {
+			out.put(uint32_t(0));
+			return;
+		}
+		encode(value->attributes, out);
+	}
+
+	template <typename Out>
+	inline static void encodeValue(void *const &value, Out &out) {
+		out.put(value);
+	}
+
+	uint32_t                     d_size = 0;
+	std::unique_ptr<std::byte[]> d_heap;
+	std::byte                    d_inline[InlineCapacity];
+};
+
+// A Record rebuilt from an EncodedRecord. All its strings and groups are owned
+// copies of the encoded ones.
+class DecodedRecord : public slog::Record {
+public:
+	inline explicit DecodedRecord(const EncodedRecord &encoded)
+	    : DecodedRecord{Reader{encoded.Data()}} {}
+
+private:
+	struct Reader {
+		const std::byte *ptr;
+
+		template <typename T> inline T get() noexcept {
+			T value;
+			memcpy(&value, ptr, sizeof(T));
+			ptr += sizeof(T);
+			return value;
+		}
+
+		inline StringType getString() {
+			auto size  = get<uint32_t>();
+			auto begin = reinterpret_cast<const char *>(ptr);
+			ptr += size;
+			return StringType{std::string{begin, size}};
+		}
+	};
+
+	// braced initialization ensures the fields are read in order.
+	inline DecodedRecord(Reader &&reader)
+	    : slog::Record{
+	          TimeT{DurationT{reader.get<int64_t>()}},
+	          reader.get<Level>(),
+	          reader.getString(),
+	      }
+	    , d_data{decodeAttributes(reader)} {
+		this->attributes = utils::ContainerReference<Attribute>(d_data);
+	}
+
+	inline static std::vector<Attribute> decodeAttributes(Reader &reader) {
+		std::vector<Attribute> attributes(reader.get<uint32_t>());
+		for (auto &attribute : attributes) {
+			attribute.key   = reader.getString();
+			attribute.value = decodeValue(reader);
+		}
+		return attributes;
+	}
+
+	template <size_t I, typename... Args>
+	inline static Value make(Args &&...args) {
+		return Value{std::in_place_index<I>, std::forward<Args>(args)...};
+	}
+
+	inline static Value decodeValue(Reader &reader) {
+		switch (reader.get<uint8_t>()) {
+		case 1:
+			return make<1>(reader.get<uint8_t>() != 0);
+		case 2:
+			return make<2>(reader.get<int64_t>());
+		case 3:
+			return make<3>(reader.get<double>());
+		case 4:
+			return make<4>(reader.getString());
+		case 5:
+			return make<5>(DurationT{reader.get<int64_t>()});
+		case 6:
+			return make<6>(TimeT{DurationT{reader.get<int64_t>()}});
+		case 7:
+			return make<7>(
+			    std::make_shared<DynamicGroup>(decodeAttributes(reader))
+			);
+		case 8:
+			return make<8>(reader.get<void *>());
+		default:
+			return Value{};
+		}
+	}
+
+	std::vector<Attribute> d_data;
+};
+
+} // namespace details
+} // namespace slog
@@ -0,0 +1,128 @@
+#include "EncodedRecord.hpp"
+#include "../Formatters.hpp"
+
+#include <gtest/gtest.h>
+
+namespace slog {
+namespace details {
+
+class EncodedRecordTest : public ::testing::Test {
+protected:
+	static std::string format(const slog::Record &record) {
+		Buffer buffer;
+		RecordToJSON(record, buffer);
+		return buffer;
+	}
+};
+
+TEST_F(EncodedRecordTest, DefaultIsEmpty) {
+	EncodedRecord encoded;
+	EXPECT_TRUE(encoded.Empty());
+	EXPECT_EQ(encoded.Timestamp(), TimeT{});
+}
+
+TEST_F(EncodedRecordTest, RoundTrip) {
+	int  value = 0;
+	auto ts    = TimeT{} + std::chrono::hours(24) + std::chrono::nanoseconds(3);
+
+	details::Record<8> record(
+	    ts,
+	    Level::Warn,
+	    "encoded record",
+	    Bool("aBool", true),
+	    Int("anInt", -42),
+	    Float("aDouble", 1.5),
+	    Attribute{},
+	    slog::String("aString", "hello world"),
+	    Duration("aDuration", std::chrono::microseconds(32)),
+	    slog::Group(
+	        "aGroup",
+	        Time("aTimestamp", TimeT{}),
+	        slog::Group(
+	            "nested",
+	            slog::String("request", "https://example.com/")
+	        )
+	    ),
+	    Pointer("aPointer", &value)
+	);
+
+	EncodedRecord encoded(record);
+	EXPECT_FALSE(encoded.Empty());
+	EXPECT_EQ(encoded.Timestamp(), ts);
+
+	DecodedRecord decoded(encoded);
+	EXPECT_EQ(decoded.timestamp, ts);
+	EXPECT_EQ(decoded.level, Level::Warn);
+	EXPECT_EQ(decoded.message, "encoded record");
+	ASSERT_EQ(decoded.attributes.size(), 8);
+	EXPECT_EQ(get<void *>(decoded.attributes.end()[-1].value), &value);
+	EXPECT_EQ(format(decoded), format(record));
+}
+
+TEST_F(EncodedRecordTest, BorrowedStringsAreCopied) {
+	std::string body = "a borrowed body";
+
+	details::Record<1> record(
+	    Level::Info,
+	    "borrowed",
+	    StringView("body", body).Borrow()
+	);
+
+	EncodedRecord encoded(record);
+	const auto    expected = format(record);
+	body.assign(body.size(), 'x');
+
+	DecodedRecord decoded(encoded);
+	ASSERT_EQ(decoded.attributes.size(), 1);
+	EXPECT_TRUE(holds_alternative<StringType>(decoded.attributes[0].value));
+	EXPECT_EQ(format(decoded), expected);
+}
+
+TEST_F(EncodedRecordTest, ContextIsDecodedAsLeadingAttributes) {
+	auto parent =
+	    std::make_shared<const ContextBlock<1>>(nullptr, 0, Int("tenant", 7));
+	auto context = std::make_shared<const ContextBlock<1>>(
+	    parent,
+	    1,
+	    slog::String("request", "/")
+	);
+
+	details::Record<1> record(Level::Info, "with context", Int("status", 200));
+	record.context = context;
+
+	DecodedRecord decoded(EncodedRecord{record});
+	EXPECT_EQ(decoded.context, nullptr);
+	ASSERT_EQ(decoded.attributes.size(), 3);
+	EXPECT_EQ(decoded.attributes[0], Int("tenant", 7));
+	EXPECT_EQ(decoded.attributes[2], Int("status", 200));
+	EXPECT_EQ(format(decoded), format(record));
+}
+
+TEST_F(EncodedRecordTest, LargeRecordsAreAllocated) {
+	details::Record<1> record(
+	    Level::Info,
+	    "large record",
+	    slog::String("aString", std::string(EncodedRecord::InlineCapacity, 'a'))
+	);
+
+	EncodedRecord encoded(record);
+	EXPECT_TRUE(encoded.Allocated());
+	EXPECT_GT(encoded.Size(), EncodedRecord::InlineCapacity);
+
+	EncodedRecord moved(std::move(encoded));
+	EXPECT_TRUE(encoded.Empty());
+	EXPECT_EQ(format(DecodedRecord{moved}), format(record));
+}
+
+TEST_F(EncodedRecordTest, Move) {
+	details::Record<1> record(Level::Info, "small", Int("anInt", 1));
+
+	EncodedRecord encoded(record), moved;
+	moved = std::move(encoded);
+	EXPECT_TRUE(encoded.Empty());
+	EXPECT_FALSE(moved.Allocated());
+	EXPECT_EQ(format(DecodedRecord{moved}), format(record));
+}
+
+} // namespace details
+} // namespace slog
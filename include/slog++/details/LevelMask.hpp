@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../Level.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace slog {
+namespace details {
+
+// The enabled levels of a sink, packed in a single atomic word, so that they
+// can be tested by the logging threads while From() or Set() changes them.
+// Bit 0 is the unknown level, as index 0 of BaseSinkConfig::levels.
+class LevelMask {
+public:
+	static_assert(NumLevels <= 32, "the levels are packed in 32 bits");
+
+	inline explicit LevelMask(const std::array<bool, NumLevels> &levels
+	) noexcept
+	    : d_mask{pack(levels)} {}
+
+	inline LevelMask(const LevelMask &other) noexcept
+	    : d_mask{other.d_mask.load(std::memory_order_relaxed)} {}
+
+	inline LevelMask &operator=(const LevelMask &other) noexcept {
+		d_mask.store(
+		    other.d_mask.load(std::memory_order_relaxed),
+		    std::memory_order_relaxed
+		);
+		return *this;
+	}
+
+	inline bool Enabled(Level lvl) const noexcept {
+		return (d_mask.load(std::memory_order_relaxed) & bit(lvl)) != 0;
+	}
+
+	// Enables the levels from lvl, and disables the ones below but unknown.
+	inline void From(Level lvl) noexcept {
+		const auto     index = size_t(lvl) + 1;
+		const uint32_t below =
+		    index >= NumLevels ? All : (uint32_t(1) << index) - 1;
+		uint32_t       mask  = d_mask.load(std::memory_order_relaxed);
+		while (!d_mask.compare_exchange_weak(
+		    mask,
+		    (mask & Unknown) | (All & ~below & ~Unknown),
+		    std::memory_order_relaxed
+		)) {
+		}
+	}
+
+	inline void Set(Level lvl, bool enabled) noexcept {
+		if (size_t(lvl) + 1 >= NumLevels) {
+			return;
+		}
+		if (enabled) {
+			d_mask.fetch_or(bit(lvl), std::memory_order_relaxed);
+		} else {
+			d_mask.fetch_and(~bit(lvl), std::memory_order_relaxed);
+		}
+	}
+
+private:
+	constexpr static uint32_t All     = (uint32_t(1) << NumLevels) - 1;
+	constexpr static uint32_t Unknown = 1;
+
+	inline constexpr static uint32_t bit(Level lvl) noexcept {
+		auto index = size_t(lvl) + 1;
+		if (index >= NumLevels) {
+			index = 0;
+		}
+		return uint32_t(1) << index;
+	}
+
+	inline static uint32_t pack(const std::array<bool, NumLevels> &levels
+	) noexcept {
+		uint32_t mask = 0;
+		for (size_t i = 0; i < NumLevels; ++i) {
+			mask |= uint32_t(levels[i]) << i;
+		}
+		return mask;
+	}
+
+	std::atomic<uint32_t> d_mask;
+};
+
+} // namespace details
+} // namespace slog
@@ -0,0 +1,69 @@
+#include "LevelMask.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace slog {
+namespace details {
+
+TEST(LevelMask, MatchesLevels) {
+	std::array<bool, NumLevels> levels{};
+	levels[size_t(Level::Info) + 1]  = true;
+	levels[size_t(Level::Error) + 1] = true;
+	LevelMask mask{levels};
+
+	EXPECT_FALSE(mask.Enabled(Level::Unknown));
+	EXPECT_FALSE(mask.Enabled(Level::Debug));
+	EXPECT_TRUE(mask.Enabled(Level::Info));
+	EXPECT_FALSE(mask.Enabled(Level::Warn));
+	EXPECT_TRUE(mask.Enabled(Level::Error));
+	EXPECT_FALSE(mask.Enabled(Level::Fatal));
+	// out of range levels are unknown.
+	EXPECT_FALSE(mask.Enabled(Level(42)));
+}
+
+TEST(LevelMask, FromAndSet) {
+	LevelMask mask{std::array<bool, NumLevels>{}};
+	mask.Set(Level::Unknown, true);
+	mask.From(Level::Warn);
+	EXPECT_TRUE(mask.Enabled(Level::Unknown));
+	EXPECT_FALSE(mask.Enabled(Level::Info));
+	EXPECT_FALSE(mask.Enabled(SubLevel<Level::Info, 3>));
+	EXPECT_TRUE(mask.Enabled(Level::Warn));
+	EXPECT_TRUE(mask.Enabled(Level::Fatal));
+
+	mask.Set(Level::Warn, false);
+	mask.Set(Level(42), true);
+	EXPECT_FALSE(mask.Enabled(Level::Warn));
+	EXPECT_TRUE(mask.Enabled(Level::Error));
+
+	mask.From(Level::Trace);
+	EXPECT_TRUE(mask.Enabled(Level::Trace));
+	EXPECT_TRUE(mask.Enabled(Level::Warn));
+	mask.From(Level(42));
+	EXPECT_FALSE(mask.Enabled(Level::Fatal));
+	EXPECT_TRUE(mask.Enabled(Level::Unknown));
+}
+
+TEST(LevelMask, ChangesWhileLogging) {
+	LevelMask mask{std::array<bool, NumLevels>{}};
+	mask.Set(Level::Error, true);
+
+	std::thread toggler{[&mask]() {
+		for (int i = 0; i < 10000; ++i) {
+			mask.Set(Level::Debug, i % 2 == 0);
+			mask.From(i % 2 == 0 ? Level::Info : Level::Trace);
+		}
+	}};
+	for (int i = 0; i < 10000; ++i) {
+		// never changed by the toggling thread.
+		ASSERT_TRUE(mask.Enabled(Level::Error));
+	}
+	toggler.join();
+	EXPECT_TRUE(mask.Enabled(Level::Debug));
+	EXPECT_TRUE(mask.Enabled(Level::Trace));
+}
+
+} // namespace details
+} // namespace slog
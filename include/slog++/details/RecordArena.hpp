@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace slog {
+namespace details {
+
+// Bump allocator for the records logged to asynchronous sinks. Each thread
+// carves its records out of its own chunk, and a chunk is recycled as a whole
+// once every record allocated from it has been destroyed, usually by the
+// consumer. In steady state, logging a record thus never calls the global
+// allocator for it.
+//
+// Each allocation is preceded by a header pointing to its chunk, whose
+// reference count tracks the live allocations, plus one while it is the
+// current chunk of its thread. Records too large for a chunk use the global
+// allocator, with a null chunk in their header.
+class RecordArena {
+public:
+	constexpr static size_t ChunkSize     = 64 * 1024;
+	constexpr static size_t MaxAllocation = ChunkSize / 8;
+	// the number of free chunks kept for reuse.
+	constexpr static size_t MaxFreeChunks = 16;
+
+	inline static void *Allocate(size_t size) {
+		size = roundUp(size + sizeof(Header));
+		if (size > MaxAllocation) {
+			auto *header  = static_cast<Header *>(::operator new(size));
+			header->chunk = nullptr;
+			return header + 1;
+		}
+
+		auto &current = threadChunk();
+		if (current.chunk == nullptr ||
+		    current.chunk->used + size > ChunkSize) {
+			current.Renew();
+		}
+		auto *chunk  = current.chunk;
+		auto *header = reinterpret_cast<Header *>(
+		    reinterpret_cast<std::byte *>(chunk) + chunk->used
+		);
+		chunk->used += size;
+		chunk->refs.fetch_add(1, std::memory_order_relaxed);
+		header->chunk = chunk;
+		return header + 1;
+	}
+
+	// May be called from any thread.
+	inline static void Deallocate(void *ptr) noexcept {
+		if (ptr == nullptr) {
+			return;
+		}
+		auto *header = static_cast<Header *>(ptr) - 1;
+		if (header->chunk == nullptr) {
+			::operator delete(header);
+			return;
+		}
+		release(header->chunk);
+	}
+
+private:
+	struct alignas(std::max_align_t) Chunk {
+		// the allocations, plus one if it is the current chunk of a thread.
+		std::atomic<size_t> refs{1};
+		// the bytes used from the beginning of the chunk, including itself.
+		size_t              used = sizeof(Chunk);
+	};
+
+	struct alignas(std::max_align_t) Header {
+		Chunk *chunk;
+	};
+
+	struct FreeChunks {
+		std::mutex           mutex;
+		std::vector<Chunk *> chunks;
+
+		// release() cannot allocate.
+		inline FreeChunks() {
+			chunks.reserve(MaxFreeChunks);
+		}
+	};
+
+	struct ThreadChunk {
+		Chunk *chunk = nullptr;
+
+		inline ~ThreadChunk() {
+			if (chunk != nullptr) {
+				release(chunk);
+			}
+		}
+
+		// Makes room for a new allocation. The current chunk is reset in place
+		// if all its records have been destroyed, or swapped for a free one.
+		inline void Renew() {
+			if (chunk != nullptr) {
+				if (chunk->refs.load(std::memory_order_acquire) == 1) {
+					chunk->used = sizeof(Chunk);
+					return;
+				}
+				release(chunk);
+			}
+			chunk = acquire();
+		}
+	};
+
+	inline static size_t roundUp(size_t size) noexcept {
+		constexpr size_t alignment = alignof(std::max_align_t);
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	inline static ThreadChunk &threadChunk() {
+		thread_local ThreadChunk instance;
+		return instance;
+	}
+
+	// Never destroyed, as records may be destroyed by other threads during
+	// the static destruction.
+	inline static FreeChunks &freeChunks() {
+		static FreeChunks *instance = new FreeChunks{};
+		return *instance;
+	}
+
+	inline static Chunk *acquire() {
+		{
+			auto                        &free = freeChunks();
+			std::scoped_lock<std::mutex> lock(free.mutex);
+			if (free.chunks.empty() == false) {
+				auto *chunk = free.chunks.back();
+				free.chunks.pop_back();
+				return new (chunk) Chunk{};
+			}
+		}
+		return new (::operator new(ChunkSize)) Chunk{};
+	}
+
+	inline static void release(Chunk *chunk) noexcept {
+		if (chunk->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+			return;
+		}
+		chunk->~Chunk();
+		{
+			auto                        &free = freeChunks();
+			std::scoped_lock<std::mutex> lock(free.mutex);
+			if (free.chunks.size() < MaxFreeChunks) {
+				free.chunks.push_back(chunk);
+				return;
+			}
+		}
+		::operator delete(chunk);
+	}
+};
+
+} // namespace details
+} // namespace slog
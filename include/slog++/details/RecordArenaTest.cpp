@@ -0,0 +1,93 @@
+#include "RecordArena.hpp"
+#include "../Record.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace slog {
+namespace details {
+
+// Runs f on a new thread, to start from an empty thread chunk.
+template <typename F> void onNewThread(F &&f) {
+	std::thread thread(std::forward<F>(f));
+	thread.join();
+}
+
+TEST(RecordArena, BumpAllocates) {
+	onNewThread([]() {
+		constexpr auto alignment = alignof(std::max_align_t);
+
+		auto *a = static_cast<std::byte *>(RecordArena::Allocate(100));
+		auto *b = static_cast<std::byte *>(RecordArena::Allocate(100));
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % alignment, 0);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % alignment, 0);
+		EXPECT_GE(b - a, 100);
+		EXPECT_LE(b - a, 100 + 2 * alignment);
+		RecordArena::Deallocate(a);
+		RecordArena::Deallocate(b);
+	});
+}
+
+TEST(RecordArena, ReusesReleasedChunk) {
+	onNewThread([]() {
+		constexpr size_t size  = 1024;
+		void            *first = RecordArena::Allocate(size);
+		RecordArena::Deallocate(first);
+
+		// once the chunk is full, it is reset as nothing references it.
+		bool reused = false;
+		for (size_t i = 0; i < RecordArena::ChunkSize / size && !reused; ++i) {
+			void *ptr = RecordArena::Allocate(size);
+			reused    = ptr == first;
+			RecordArena::Deallocate(ptr);
+		}
+		EXPECT_TRUE(reused);
+	});
+}
+
+TEST(RecordArena, KeepsReferencedChunk) {
+	onNewThread([]() {
+		constexpr size_t size  = 1024;
+		void            *first = RecordArena::Allocate(size);
+		std::memset(first, 0x2a, size);
+
+		for (size_t i = 0; i < 4 * RecordArena::ChunkSize / size; ++i) {
+			void *ptr = RecordArena::Allocate(size);
+			EXPECT_NE(ptr, first);
+			RecordArena::Deallocate(ptr);
+		}
+		EXPECT_EQ(static_cast<unsigned char *>(first)[size - 1], 0x2a);
+		RecordArena::Deallocate(first);
+	});
+}
+
+TEST(RecordArena, LargeAllocations) {
+	void *ptr = RecordArena::Allocate(RecordArena::MaxAllocation + 1);
+	std::memset(ptr, 0, RecordArena::MaxAllocation + 1);
+	RecordArena::Deallocate(ptr);
+	RecordArena::Deallocate(nullptr);
+}
+
+TEST(RecordArena, ReleasedFromOtherThread) {
+	std::vector<std::unique_ptr<const slog::Record>> records;
+	onNewThread([&records]() {
+		for (int i = 0; i < 1000; ++i) {
+			records.push_back(std::make_unique<const details::Record<2>>(
+			    Level::Info,
+			    "record",
+			    Int("index", i),
+			    slog::String("aString", "a string longer than its SSO buffer")
+			));
+		}
+	});
+	// the producing thread exited, the consumer releases the chunks.
+	EXPECT_EQ(get<int64_t>(records.back()->attributes[0].value), 999);
+	records.clear();
+}
+
+} // namespace details
+} // namespace slog
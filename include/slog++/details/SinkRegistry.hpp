@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../Sink.hpp"
+#include "../Types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace slog {
+namespace details {
+
+// Tracks the live asynchronous sinks, to drain them all before the process
+// aborts or exits. Sinks are only weakly referenced.
+class SinkRegistry {
+public:
+	inline void Register(std::weak_ptr<slog::Sink> sink) {
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		std::erase_if(d_sinks, [](const auto &s) { return s.expired(); });
+		d_sinks.push_back(std::move(sink));
+	}
+
+	// Flushes all live sinks, and waits up to timeout for them. Returns false
+	// if the timeout expired.
+	inline bool FlushAll(DurationT timeout) {
+		std::vector<std::shared_ptr<slog::Sink>> sinks;
+		{
+			std::scoped_lock<std::mutex> lock(d_mutex);
+			for (const auto &s : d_sinks) {
+				if (auto sink = s.lock()) {
+					sinks.push_back(std::move(sink));
+				}
+			}
+		}
+
+		auto barrier = std::make_shared<FlushBarrier>();
+		auto done    = barrier->Future();
+		for (auto &sink : sinks) {
+			sink->Flush(barrier);
+		}
+		barrier.reset();
+		sinks.clear();
+
+		if (timeout == DurationT::max()) {
+			done.wait();
+			return true;
+		}
+		return done.wait_for(timeout) == std::future_status::ready;
+	}
+
+private:
+	std::mutex                             d_mutex;
+	std::vector<std::weak_ptr<slog::Sink>> d_sinks;
+};
+
+inline SinkRegistry &asyncSinks() {
+	static SinkRegistry instance;
+	return instance;
+}
+
+// The maximal time spent draining the async sinks before a Fatal() aborts.
+constexpr DurationT FatalDrainTimeout = std::chrono::seconds(1);
+
+inline bool drainAsyncSinks(DurationT timeout) {
+	return asyncSinks().FlushAll(timeout);
+}
+
+// Drains the async sinks at exit() and quick_exit(). Only the first call
+// installs the handlers, later ones only update the timeout. The handlers run
+// after the destruction of the static loggers built later, but the sinks of
+// these loggers remain alive, and registered, until their records are
+// drained.
+inline void drainOnExit(DurationT timeout) {
+	static std::atomic<DurationT::rep> exitTimeout{0};
+	static std::once_flag              installed;
+
+	exitTimeout.store(timeout.count(), std::memory_order_relaxed);
+	std::call_once(installed, []() {
+		// the registry must outlive the handlers.
+		asyncSinks();
+		void (*handler)() = []() {
+			drainAsyncSinks(
+			    DurationT{exitTimeout.load(std::memory_order_relaxed)}
+			);
+		};
+		std::atexit(handler);
+		std::at_quick_exit(handler);
+	});
+}
+
+} // namespace details
+} // namespace slog
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace slog {
+namespace details {
+
+// A null terminated string with static storage duration, such as a literal,
+// which details::String only references. See slog::Literal().
+struct StaticString {
+	const char *data;
+	size_t      size;
+
+	inline constexpr std::string_view View() const noexcept {
+		return std::string_view{data, size};
+	}
+
+	// std::string cannot reference it, and copies it.
+	inline operator std::string() const {
+		return std::string{data, size};
+	}
+};
+
+} // namespace details
+} // namespace slog
@@ -1,11 +1,15 @@
 #pragma once
 
+#include "StaticString.hpp"
+
 #include <array>
 #include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
+#include <string>
+#include <type_traits>
 
 #if defined(_MSC_VER)
 #include <intrin.h>
@@ -17,6 +21,11 @@ namespace details {
 
 // This is a small string optimized String class that uses fewer stack
 // memory, but has SSO. Inspired by meta's fbstring class.
+//
+// Static strings, such as the literals given to slog::Literal(), are only
+// referenced, whatever their size: they are never copied, and copying such a
+// String only copies the reference. Other strings, including constant
+// arrays, which may be automatic variables, are copied.
 class String {
 
 	// an helper to ensure that size is BE, so its LSB is the struct LSB when it
@@ -59,7 +68,16 @@ public:
 		initFromString(s);
 	}
 
-	constexpr String(const char *c_str) {
+	// Only referenced, as it outlives any String.
+	constexpr String(StaticString literal) {
+		d.large.data = const_cast<char *>(literal.data);
+		// the literal is null terminated, so size() handles the odd encoding.
+		d.large.size_BE = sizeMayBitswap(literal.size | 1 | StaticFlag);
+	}
+
+	template <typename T>
+	    requires std::is_same_v<T, const char *> || std::is_same_v<T, char *>
+	constexpr String(T c_str) {
 		size_t s = 0;
 		while (c_str[s] != '\0') {
 			++s;
@@ -78,16 +96,16 @@ public:
 	}
 
 	constexpr ~String() {
-		if (isSmall()) {
+		if (isOwned() == false) {
 			return;
 		}
 		delete[] d.large.data;
 	}
 
 	String(const String &other) {
-		if (other.isSmall() == true) {
-			d.small = other.d.small;
-			// SSO: no heap memory, we are done.
+		if (other.isOwned() == false) {
+			d = other.d;
+			// SSO or literal: no heap memory, we are done.
 			return;
 		}
 		d.large.data    = new char[other.size() + 1];
@@ -100,11 +118,11 @@ public:
 			return *this;
 		}
 
-		if (other.isSmall() == true) {
-			if (isSmall() == false) {
+		if (other.isOwned() == false) {
+			if (isOwned() == true) {
 				delete[] d.large.data;
 			}
-			// SSO: no heap memory, we are done.
+			// SSO or literal: no heap memory, we are done.
 			d = other.d;
 			return *this;
 		}
@@ -113,7 +131,7 @@ public:
 
 		auto newBytes = new char[allocatedSize];
 
-		if (isSmall() == false) {
+		if (isOwned() == true) {
 			delete[] d.large.data;
 		}
 
@@ -135,7 +153,7 @@ public:
 			return *this;
 		}
 
-		if (isSmall() == false && d.large.data != nullptr) {
+		if (isOwned() == true && d.large.data != nullptr) {
 			delete[] d.large.data;
 		}
 
@@ -152,7 +170,7 @@ public:
 		}
 		// size is Big-Endian encoded, so only the last bit should be checked,
 		// and it correspond to the LSB of the struct.
-		auto s = sizeMayBitswap(d.large.size_BE);
+		auto s = sizeMayBitswap(d.large.size_BE) & ~StaticFlag;
 		if (d.large.data[s - 1] == 0) {
 			return s - 1;
 		}
@@ -207,6 +225,16 @@ private:
 		d.small.data[0] = '\0';
 	}
 
+	// set in the size of a referenced literal. As the size is Big-Endian, it
+	// is in the first byte of the size, away from the small representation
+	// flag.
+	constexpr static size_t StaticFlag = size_t(1) << 63;
+
+	inline constexpr bool isOwned() const noexcept {
+		return isSmall() == false &&
+		       (sizeMayBitswap(d.large.size_BE) & StaticFlag) == 0;
+	}
+
 	inline constexpr bool isSmall() const noexcept {
 
 		// check if the LSB of the struct is set. If yes, we are a long string,
@@ -1,4 +1,5 @@
 #include "String.hpp"
+#include "../Types.hpp"
 #include <gtest/gtest.h>
 
 namespace slog {
@@ -35,6 +36,46 @@ TEST_F(StringTest, RepresentationIsCorrect) {
 	}
 }
 
+TEST_F(StringTest, LiteralsAreReferenced) {
+	constexpr auto shortLiteral = Literal("short");
+	constexpr auto longLiteral  = Literal("a literal longer than the SSO");
+
+	for (const auto &tagged : {shortLiteral, longLiteral}) {
+		const char *literal = tagged.data;
+		SCOPED_TRACE(literal);
+		String r(tagged);
+		EXPECT_EQ(r.c_str(), literal);
+		EXPECT_EQ(r.string_view(), literal);
+
+		String copy(r);
+		EXPECT_EQ(copy.c_str(), literal);
+		String owned(std::string(32, 'x'));
+		owned = r;
+		EXPECT_EQ(owned.c_str(), literal);
+		owned = String(std::string(32, 'y'));
+		EXPECT_EQ(owned.string_view(), std::string(32, 'y'));
+		String moved(std::move(copy));
+		EXPECT_EQ(moved.c_str(), literal);
+		EXPECT_EQ(copy.size(), 0);
+	}
+}
+
+TEST_F(StringTest, ConstantArraysAreCopied) {
+	// may be an automatic variable, not outliving the String.
+	const char array[] = "a constant array longer than the SSO";
+	String     r(array);
+	EXPECT_NE(r.c_str(), array);
+	EXPECT_EQ(r.string_view(), "a constant array longer than the SSO");
+}
+
+TEST_F(StringTest, BuffersAreCopied) {
+	char   buffer[] = "a buffer longer than the SSO";
+	String r(buffer);
+	buffer[0] = 'X';
+	EXPECT_NE(r.c_str(), buffer);
+	EXPECT_EQ(r.string_view(), "a buffer longer than the SSO");
+}
+
 TEST_F(StringTest, LargeStringWithTrailingNullDoesNotKeepExactSize) {
 	// due to the always odd-encoding of a size, a std::string containing
 	// trailing null character will report the wrong size. The implementation
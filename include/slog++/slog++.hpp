@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Config.hpp"
+#include "Emergency.hpp"
 #include "Logger.hpp"
 
 namespace slog {
@@ -8,15 +9,28 @@ namespace slog {
 template <typename... Options>
 std::shared_ptr<Sink> BuildSink(Options &&...options);
 
+// Builds the sink configured by options as a SinkT, to type a Logger. Throws
+// std::invalid_argument if options do not configure a single SinkT, such as
+// FileSink<MTSafe> for a synchronous sink with locking.
+template <typename SinkT, typename... Options>
+std::shared_ptr<SinkT> BuildTypedSink(Options &&...options);
+
 Logger<0> &DefaultLogger();
 
+// Writes and flushes the records queued in every async sink, waiting up to
+// timeout. Returns false if the timeout expired.
+bool Drain(DurationT timeout = DurationT::max());
+
 template <typename... Attributes>
 inline Logger<sizeof...(Attributes)> With(Attributes &&...attributes) {
 	return DefaultLogger().With(std::forward<Attributes>(attributes)...);
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void Log(Level level, Str &&message, Attributes &&...attributes) {
+	if (level < Min) {
+		return;
+	}
 	DefaultLogger().Log(
 	    level,
 	    std::forward<Str>(message),
@@ -24,44 +38,54 @@ inline void Log(Level level, Str &&message, Attributes &&...attributes) {
 	);
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void Trace(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Trace(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Trace >= Min) {
+		DefaultLogger().Trace(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void Debug(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Debug(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Debug >= Min) {
+		DefaultLogger().Debug(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void Info(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Info(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Info >= Min) {
+		DefaultLogger().Info(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void Warn(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Warn(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Warn >= Min) {
+		DefaultLogger().Warn(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void Error(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Error(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Error >= Min) {
+		DefaultLogger().Error(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
 template <typename Str, typename... Attributes>
@@ -73,44 +97,54 @@ inline void Fatal(Str &&message, Attributes &&...attributes) {
 }
 
 #ifndef NDEBUG
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void DTrace(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Trace(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Trace >= Min) {
+		DefaultLogger().Trace(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void DDebug(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Debug(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Debug >= Min) {
+		DefaultLogger().Debug(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void DInfo(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Info(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Info >= Min) {
+		DefaultLogger().Info(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void DWarn(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Warn(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Warn >= Min) {
+		DefaultLogger().Warn(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
-template <typename Str, typename... Attributes>
+template <typename Str, typename... Attributes, Level Min = MinLevel>
 inline void DError(Str &&message, Attributes &&...attributes) {
-	DefaultLogger().Error(
-	    std::forward<Str>(message),
-	    std::forward<Attributes>(attributes)...
-	);
+	if constexpr (Level::Error >= Min) {
+		DefaultLogger().Error(
+		    std::forward<Str>(message),
+		    std::forward<Attributes>(attributes)...
+		);
+	}
 }
 
 #else
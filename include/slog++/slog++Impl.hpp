@@ -9,6 +9,10 @@
 
 namespace slog {
 
+inline bool Drain(DurationT timeout) {
+	return details::drainAsyncSinks(timeout);
+}
+
 inline Logger<0> &DefaultLogger() {
 	static Logger<0> instance{BuildSink()};
 	return instance;
@@ -52,6 +56,19 @@ inline std::shared_ptr<Sink> BuildSink(Options &&...options) {
 	(std::forward<Options>(options)(config), ...);
 	details::Sanitize(config);
 
+	if (config.threadPoolSize > details::threadPool.Size()) {
+		details::threadPool.SetSize(config.threadPoolSize);
+	}
+	if (config.exitDrainTimeout > DurationT::zero()) {
+		details::drainOnExit(config.exitDrainTimeout);
+	}
+	if (config.bufferPoolObjects > 0 || config.bufferPoolBytes > 0) {
+		decltype(details::bufferPool)::Limits limits;
+		limits.maxObjects = config.bufferPoolObjects;
+		limits.maxBytes   = config.bufferPoolBytes;
+		details::bufferPool.SetLimits(limits);
+	}
+
 	if (config.sinks.size() == 1) {
 		return details::BuildSink(config.sinks.front());
 	}
@@ -65,4 +82,17 @@ inline std::shared_ptr<Sink> BuildSink(Options &&...options) {
 	return std::make_shared<details::MultiSink>(std::move(sinks));
 }
 
+template <typename SinkT, typename... Options>
+inline std::shared_ptr<SinkT> BuildTypedSink(Options &&...options) {
+	auto sink = std::dynamic_pointer_cast<SinkT>(
+	    BuildSink(std::forward<Options>(options)...)
+	);
+	if (!sink) {
+		throw std::invalid_argument(
+		    "options do not configure a single sink of the requested type"
+		);
+	}
+	return sink;
+}
+
 } // namespace slog
@@ -4,6 +4,10 @@
 
 #include <slog++/slog++.hpp>
 
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
 namespace slog {
 
 const static std::string rfc3339 =
@@ -38,4 +42,127 @@ TEST(SlogDefaultLogger, MultiLine) {
 	);
 }
 
+TEST(SlogTypedLogger, Stderr) {
+	auto sink = BuildTypedSink<FileSink<MTSafe>>(WithProgramOutput(
+	    WithLocking(),
+	    WithFormat(OutputFormat::TEXT),
+	    FromLevel(Level::Info)
+	));
+	Logger<0, FileSink<MTSafe>, JSONFormatter> logger{sink};
+
+	::testing::internal::CaptureStderr();
+	logger.Debug("dropped");
+	logger.With(String("domain", "coucou")).Info("ok", Int("a", 23));
+	auto res = ::testing::internal::GetCapturedStderr();
+	EXPECT_THAT(
+	    res,
+	    ::testing::MatchesRegex(
+	        R"--(^\{"time":")--" + rfc3339 +
+	        R"--(","level":"INFO","message":"ok",)--"
+	        R"--("domain":"coucou","a":23\})--" + "\n$"
+	    )
+	);
+
+	EXPECT_THROW(
+	    BuildTypedSink<FileSink<MTSafe>>(WithProgramOutput()),
+	    std::invalid_argument
+	);
+}
+
+TEST(SlogTypedLogger, PlannedFields) {
+	auto sink = BuildTypedSink<FileSink<MTSafe>>(WithProgramOutput(
+	    WithLocking(),
+	    WithFormat(OutputFormat::TEXT),
+	    FromLevel(Level::Info)
+	));
+	Logger<0, FileSink<MTSafe>, JSONFormatter> logger{sink};
+
+	// encoded through the plan of JSONFormatter, as their keys are literals.
+	static_assert(details::FieldsFormatter<
+	              JSONFormatter,
+	              decltype(Int<"a">(23)),
+	              decltype(StringView<"b">("c"))>);
+	::testing::internal::CaptureStderr();
+	logger.With(String("domain", "coucou"))
+	    .Info("ok", Int<"a">(23), StringView<"b">("c"));
+	auto res = ::testing::internal::GetCapturedStderr();
+	EXPECT_THAT(
+	    res,
+	    ::testing::MatchesRegex(
+	        R"--(^\{"time":")--" + rfc3339 +
+	        R"--(","level":"INFO","message":"ok",)--"
+	        R"--("domain":"coucou","a":23,"b":"c"\})--" + "\n$"
+	    )
+	);
+}
+
+#ifdef __linux__
+TEST(SlogFileSink, ReportsFailedWrites) {
+	// every write fails with ENOSPC.
+	auto sink = BuildTypedSink<FileSink<Async>>(WithFileOutput(
+	    "/dev/full",
+	    WithAsync(),
+	    WithBatchLimits(2, 1024),
+	    FromLevel(Level::Info)
+	));
+	Logger<0> logger{sink};
+	for (int i = 0; i < 3; ++i) {
+		logger.Info(std::to_string(i));
+	}
+	EXPECT_TRUE(logger.Flush());
+	EXPECT_EQ(sink->Dropped(), 3);
+}
+
+TEST(SlogFileSink, LogsBeyondTheEmergencyOutputs) {
+	std::vector<std::shared_ptr<FileSink<STSafe>>> sinks;
+	for (size_t i = 0; i <= details::EmergencyOutput::MaxOutputs; ++i) {
+		ASSERT_NO_THROW(sinks.push_back(BuildTypedSink<FileSink<STSafe>>(
+		    WithFileOutput("/dev/null", FromLevel(Level::Info))
+		)));
+	}
+	Logger<0> logger{sinks.back()};
+	logger.Info("not registered for EmergencyLog()");
+	EXPECT_TRUE(logger.Flush());
+}
+
+// Logs count records with a static async logger, then exits without
+// flushing it. The logger is destroyed before the exit handler of
+// WithDrainOnExit() runs.
+[[noreturn]] static void
+logFromStaticLogger(const std::string &path, int count) {
+	static Logger<0> logger{BuildSink(
+	    WithFileOutput(path, WithAsync(), FromLevel(Level::Info)),
+	    WithDrainOnExit(std::chrono::seconds(2))
+	)};
+	for (int i = 0; i < count; ++i) {
+		logger.Info(std::to_string(i));
+	}
+	std::exit(0);
+}
+
+TEST(SlogDrainOnExitDeathTest, StaticLogger) {
+	// a fresh process, without the threads of the other tests.
+	GTEST_FLAG_SET(death_test_style, "threadsafe");
+	// few records, so that the sink may not be drained yet at exit.
+	constexpr static int Count = 10;
+
+	const auto path = ::testing::TempDir() + "slog-drain-on-exit.log";
+	std::remove(path.c_str());
+
+	EXPECT_EXIT(
+	    logFromStaticLogger(path, Count),
+	    ::testing::ExitedWithCode(0),
+	    ""
+	);
+
+	std::ifstream in(path);
+	int           lines = 0;
+	for (std::string line; std::getline(in, line);) {
+		++lines;
+	}
+	EXPECT_EQ(lines, Count);
+	std::remove(path.c_str());
+}
+#endif
+
 } // namespace slog
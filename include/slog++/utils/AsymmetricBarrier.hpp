@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+
+#ifdef __linux__
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace slog {
+namespace utils {
+
+// A full memory barrier split between a fast and a slow side. Two threads
+// that store, then call Light() or Heavy(), then load, cannot both miss the
+// store of the other, as with a sequentially consistent fence on both sides.
+//
+// On Linux, Light() is only a compiler barrier, and Heavy() forces a full
+// barrier on every running thread of the process with membarrier(2). It fits
+// a frequent path, such as a producer pushing records, paired with a rare
+// one, such as a consumer about to sleep. Elsewhere, or if membarrier(2) is
+// not available, both sides issue a sequentially consistent fence.
+class AsymmetricBarrier {
+public:
+	inline static void Light() noexcept {
+		if (expedited()) {
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+		} else {
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+	}
+
+	inline static void Heavy() noexcept {
+#ifdef __linux__
+		if (expedited() &&
+		    syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0) ==
+		        0) {
+			return;
+		}
+#endif
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+private:
+	// Returns true if the process is registered for expedited membarrier(2),
+	// after which the command cannot fail.
+	inline static bool expedited() noexcept {
+#ifdef __linux__
+		static const bool registered =
+		    syscall(
+		        SYS_membarrier,
+		        MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED,
+		        0,
+		        0
+		    ) == 0;
+		return registered;
+#else
+		return false;
+#endif
+	}
+};
+
+} // namespace utils
+} // namespace slog
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "AsymmetricBarrier.hpp"
+
+namespace slog {
+namespace utils {
+
+// The store buffering litmus test: each side stores its round, then loads the
+// round of the other one, which cannot both be stale.
+TEST(AsymmetricBarrier, SidesDoNotBothMissTheOtherStore) {
+	constexpr int Rounds = 10000;
+
+	std::atomic<int> light{0}, heavy{0}, started{0}, finished{0};
+	std::vector<int> seenByLight(Rounds), seenByHeavy(Rounds);
+
+	std::thread other([&]() {
+		for (int i = 1; i <= Rounds; ++i) {
+			while (started.load(std::memory_order_acquire) < i) {
+				std::this_thread::yield();
+			}
+			heavy.store(i, std::memory_order_relaxed);
+			AsymmetricBarrier::Heavy();
+			seenByHeavy[i - 1] = light.load(std::memory_order_relaxed);
+			finished.store(i, std::memory_order_release);
+		}
+	});
+
+	for (int i = 1; i <= Rounds; ++i) {
+		started.store(i, std::memory_order_release);
+		light.store(i, std::memory_order_relaxed);
+		AsymmetricBarrier::Light();
+		seenByLight[i - 1] = heavy.load(std::memory_order_relaxed);
+		while (finished.load(std::memory_order_acquire) < i) {
+			std::this_thread::yield();
+		}
+	}
+	other.join();
+
+	for (int i = 1; i <= Rounds; ++i) {
+		ASSERT_TRUE(seenByLight[i - 1] == i || seenByHeavy[i - 1] == i)
+		    << "round " << i;
+	}
+}
+
+} // namespace utils
+} // namespace slog
@@ -1,86 +1,516 @@
 #pragma once
 
 #include <algorithm>
-#include <condition_variable>
-#include <functional>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <mutex>
+#include <new>
 #include <type_traits>
+#include <vector>
 
 namespace slog {
 
 namespace utils {
 
+// A pool of reusable objects. Each thread caches up to two magazines of
+// MagazineSize free objects, so Get() and releases are usually served
+// without any synchronization. Full magazines are exchanged in batches with
+// a lock-free depot shared by all threads, of at most DepotSize magazines:
+// objects that would not fit are destroyed.
+//
+// The pool keeps track of the peak number of objects in use, over periods of
+// Limits::trimPeriod. Free objects in the depot beyond the peak of the last
+// two periods are destroyed, so the memory goes back to its baseline after a
+// burst. After such a trimming, each thread gives its cached objects back to
+// the depot on its next use of the pool, for them to be trimmed too. Objects
+// cached by a thread which no longer uses the pool stay there until it exits,
+// or until the pool is destroyed if it is the destroying thread.
+//
+// The number and size of the free objects can also be capped: released
+// objects that would exceed the limits are destroyed right away.
 template <
     typename T,
     std::enable_if_t<std::is_nothrow_constructible_v<T>> * = nullptr>
 class ObjectPool {
+	struct Node;
+
 public:
-	using ReAnnounce = std::function<void(T *)>;
-	using Ptr        = std::unique_ptr<T, ReAnnounce>;
+	constexpr static size_t MagazineSize = 32;
+	constexpr static size_t DepotSize    = 64;
+	// the number of Get() calls by a thread between two trimming checks.
+	constexpr static size_t CheckInterval = 1024;
+
+	struct Limits {
+		// released objects are destroyed while the pool holds more objects,
+		// in use or not. 0 for no limit.
+		size_t                              maxObjects = 0;
+		// the maximal size of the free objects, as returned by BytesOf(). 0
+		// for no limit.
+		size_t                              maxBytes   = 0;
+		// zero disables the trimming of unused objects.
+		std::chrono::steady_clock::duration trimPeriod =
+		    std::chrono::seconds(10);
+	};
+
+	// Stateless, objects find their pool themselves.
+	struct Deleter {
+		inline void operator()(T *object) const noexcept {
+			release(Node::Of(object));
+		}
+	};
+
+	using Ptr = std::unique_ptr<T, Deleter>;
 
+	inline ObjectPool(const Limits &limits = {})
+	    : d_core{std::make_shared<Core>()} {
+		SetLimits(limits);
+	}
+
+	// Waits for all the objects to be released.
 	inline ~ObjectPool() {
-		std::unique_lock<std::mutex> lock(d_mutex);
-		d_condition.wait(lock, [this]() {
-			return d_available.size() == d_objects.size();
-		});
+		auto &core = *d_core;
+		core.closing.store(true, std::memory_order_seq_cst);
+		for (auto inUse = core.inUse.load(std::memory_order_seq_cst);
+		     inUse != 0;
+		     inUse = core.inUse.load(std::memory_order_seq_cst)) {
+			core.inUse.wait(inUse, std::memory_order_seq_cst);
+		}
 
-		for (auto obj : d_available) {
-			delete obj;
+		if (auto *caches = localCaches()) {
+			std::erase_if(*caches, [&core](const auto &cache) {
+				return cache->core.get() == &core;
+			});
 		}
+		core.Clear();
 	}
 
-	ObjectPool()                              = default;
 	// ObjectPool is non-movable non-copyable
 	ObjectPool(const ObjectPool &)            = delete;
 	ObjectPool(ObjectPool &&)                 = delete;
 	ObjectPool &operator=(const ObjectPool &) = delete;
 	ObjectPool &operator=(ObjectPool &&)      = delete;
 
+	// Creates free objects in the depot, until the pool holds capacity
+	// objects or the depot is full.
 	void Reserve(size_t capacity) {
-		std::scoped_lock<std::mutex> lock(d_mutex);
-
-		while (d_objects.size() < capacity) {
-			d_available.push_back(d_objects.emplace_back(new T()));
+		auto &core = *d_core;
+		while (core.capacity.load(std::memory_order_relaxed) < capacity) {
+			Node *chain = nullptr;
+			for (size_t i = 0; i < MagazineSize &&
+			                   core.capacity.load(std::memory_order_relaxed) <
+			                       capacity;
+			     ++i) {
+				chain = core.Create(chain);
+			}
+			if (core.Deposit(chain) == false) {
+				Core::Destroy(chain);
+				return;
+			}
 		}
 	}
 
 	Ptr Get() noexcept {
-		std::scoped_lock<std::mutex> lock(d_mutex);
+		auto &core = *d_core;
+		Node *node = nullptr;
+		if (auto *cache = localCache(core)) {
+			if (++cache->gets == CheckInterval) {
+				cache->gets = 0;
+				core.Maintain();
+			}
+			cache->Sync();
+			if (cache->size == 0) {
+				cache->Refill();
+			}
+			if (cache->size > 0) {
+				node = cache->nodes[--cache->size];
+			}
+		}
+		if (node == nullptr) {
+			node = core.Create(nullptr);
+		} else {
+			core.freeBytes.fetch_sub(node->bytes, std::memory_order_relaxed);
+		}
+		auto inUse = core.inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+		if (inUse > core.peak.load(std::memory_order_relaxed)) {
+			core.peak.store(inUse, std::memory_order_relaxed);
+		}
+		return Ptr{node->Object()};
+	}
 
-		if (d_available.empty() == true) {
-			d_available.push_back(d_objects.emplace_back(new T()));
+	inline void SetLimits(const Limits &limits) noexcept {
+		auto &core = *d_core;
+		core.maxObjects.store(limits.maxObjects, std::memory_order_relaxed);
+		core.maxBytes.store(limits.maxBytes, std::memory_order_relaxed);
+		core.trimPeriod.store(
+		    limits.trimPeriod.count(),
+		    std::memory_order_relaxed
+		);
+	}
+
+	// Destroys the free objects beyond the ones in use. The objects cached
+	// by the other threads are only destroyed on their next use of the pool.
+	inline void Trim() noexcept {
+		auto &core  = *d_core;
+		auto  inUse = core.inUse.load(std::memory_order_relaxed);
+		core.peak.store(inUse, std::memory_order_relaxed);
+		core.previousPeak.store(inUse, std::memory_order_relaxed);
+		core.trimEpoch.fetch_add(1, std::memory_order_relaxed);
+		if (auto *cache = localCache(core)) {
+			cache->Sync();
 		}
+		core.TrimDepot();
+	}
 
-		auto ptr = d_available.back();
-		d_available.pop_back();
+	// Returns the number of free objects destroyed because of the limits or
+	// of trimming.
+	size_t Trimmed() noexcept {
+		return d_core->trimmed.load(std::memory_order_relaxed);
+	}
 
-		return {ptr, [this](T *obj) { this->announce(obj); }};
+	// Returns the size accounted for object in maxBytes.
+	inline static size_t BytesOf(const T &object) noexcept {
+		if constexpr (requires {
+			              typename T::value_type;
+			              { object.capacity() } -> std::convertible_to<size_t>;
+		              }) {
+			return sizeof(T) +
+			       object.capacity() * sizeof(typename T::value_type);
+		} else {
+			return sizeof(T);
+		}
 	}
 
+	// Returns the number of objects which are not in use.
 	size_t Available() noexcept {
-		std::scoped_lock<std::mutex> lock(d_mutex);
-		return d_available.size();
+		return d_core->capacity.load(std::memory_order_relaxed) -
+		       d_core->inUse.load(std::memory_order_relaxed);
 	}
 
+	// Returns the number of objects owned by the pool, in use or not.
 	size_t Capacity() noexcept {
-		std::scoped_lock<std::mutex> lock(d_mutex);
-		return d_objects.size();
+		return d_core->capacity.load(std::memory_order_relaxed);
 	}
 
 private:
-	void announce(T *object) {
-		std::scoped_lock<std::mutex> lock(d_mutex);
+	struct Core;
+
+	// An object, along with the pool it belongs to. Free nodes are chained in
+	// magazines through next.
+	struct Node {
+		Core  *core;
+		Node  *next  = nullptr;
+		// BytesOf() the object when it was released.
+		size_t bytes = 0;
+		alignas(T) std::byte storage[sizeof(T)]{};
+
+		inline T *Object() noexcept {
+			return std::launder(reinterpret_cast<T *>(storage));
+		}
+
+		inline static Node *Of(T *object) noexcept {
+			return reinterpret_cast<Node *>(
+			    reinterpret_cast<std::byte *>(object) - offsetof(Node, storage)
+			);
+		}
+	};
+
+	// The state shared by the pool and the thread caches, which may outlive
+	// it.
+	struct Core : std::enable_shared_from_this<Core> {
+		using Rep = std::chrono::steady_clock::rep;
+
+		std::atomic<size_t> capacity{0};
+		std::atomic<size_t> inUse{0};
+		std::atomic<size_t> freeBytes{0};
+		std::atomic<size_t> trimmed{0};
+		std::atomic<bool>   closing{false};
+		// each slot holds a chain of up to MagazineSize free nodes.
+		std::array<std::atomic<Node *>, DepotSize> depot{};
+
+		std::atomic<size_t> maxObjects{0};
+		std::atomic<size_t> maxBytes{0};
+		std::atomic<Rep>    trimPeriod{0};
+		// the peak number of objects in use during the current and the
+		// previous periods.
+		std::atomic<size_t> peak{0};
+		std::atomic<size_t> previousPeak{0};
+		std::atomic<Rep>    periodStart{0};
+		// incremented by each trimming, for the thread caches to give their
+		// nodes back to the depot.
+		std::atomic<uint64_t> trimEpoch{0};
+
+		inline ~Core() {
+			Clear();
+		}
+
+		// Destroys the nodes of the depot.
+		inline void Clear() noexcept {
+			for (auto &slot : depot) {
+				Destroy(slot.exchange(nullptr, std::memory_order_acquire));
+			}
+		}
+
+		// Returns a new node chained to next.
+		inline Node *Create(Node *next) noexcept {
+			auto *node = new Node{this, next};
+			new (node->storage) T();
+			capacity.fetch_add(1, std::memory_order_relaxed);
+			return node;
+		}
+
+		// Destroys a chain of free nodes.
+		inline static void Destroy(Node *chain) noexcept {
+			while (chain != nullptr) {
+				auto *next = chain->next;
+				auto &core = *chain->core;
+				core.freeBytes.fetch_sub(
+				    chain->bytes,
+				    std::memory_order_relaxed
+				);
+				core.capacity.fetch_sub(1, std::memory_order_relaxed);
+				chain->Object()->~T();
+				delete chain;
+				chain = next;
+			}
+		}
+
+		// Destroys a chain of free nodes because of the limits or trimming.
+		inline void Discard(Node *chain) noexcept {
+			for (auto *node = chain; node != nullptr; node = node->next) {
+				trimmed.fetch_add(1, std::memory_order_relaxed);
+			}
+			Destroy(chain);
+		}
+
+		// Returns true if the free objects exceed the limits.
+		inline bool OverLimits() const noexcept {
+			auto objects = maxObjects.load(std::memory_order_relaxed);
+			auto bytes   = maxBytes.load(std::memory_order_relaxed);
+			return (objects > 0 &&
+			        capacity.load(std::memory_order_relaxed) > objects) ||
+			       (bytes > 0 &&
+			        freeBytes.load(std::memory_order_relaxed) > bytes);
+		}
+
+		// Starts a new period if the current one is over, and trims the
+		// depot.
+		inline void Maintain() noexcept {
+			auto period = trimPeriod.load(std::memory_order_relaxed);
+			if (period == 0) {
+				return;
+			}
+			using clock = std::chrono::steady_clock;
+			Rep now     = clock::now().time_since_epoch().count();
+			Rep start   = periodStart.load(std::memory_order_relaxed);
+			if (now - start < period ||
+			    periodStart.compare_exchange_strong(
+			        start,
+			        now,
+			        std::memory_order_relaxed
+			    ) == false) {
+				return;
+			}
+			previousPeak.store(
+			    peak.exchange(
+			        inUse.load(std::memory_order_relaxed),
+			        std::memory_order_relaxed
+			    ),
+			    std::memory_order_relaxed
+			);
+			trimEpoch.fetch_add(1, std::memory_order_relaxed);
+			TrimDepot();
+		}
+
+		// Destroys the chains of the depot while the pool holds more objects
+		// than the recent demand, or while the limits are exceeded.
+		inline void TrimDepot() noexcept {
+			const size_t demand = std::max(
+			    peak.load(std::memory_order_relaxed),
+			    previousPeak.load(std::memory_order_relaxed)
+			);
+			while (capacity.load(std::memory_order_relaxed) > demand ||
+			       OverLimits()) {
+				auto *chain = Withdraw();
+				if (chain == nullptr) {
+					return;
+				}
+				Discard(chain);
+			}
+		}
+
+		// Stores a chain in a free depot slot. Returns false if there is
+		// none.
+		inline bool Deposit(Node *chain) noexcept {
+			for (auto &slot : depot) {
+				Node *expected = nullptr;
+				if (slot.load(std::memory_order_relaxed) == nullptr &&
+				    slot.compare_exchange_strong(
+				        expected,
+				        chain,
+				        std::memory_order_release,
+				        std::memory_order_relaxed
+				    )) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Takes a chain out of the depot, or returns nullptr if it is empty.
+		inline Node *Withdraw() noexcept {
+			for (auto &slot : depot) {
+				if (slot.load(std::memory_order_relaxed) == nullptr) {
+					continue;
+				}
+				if (auto *chain =
+				        slot.exchange(nullptr, std::memory_order_acquire)) {
+					return chain;
+				}
+			}
+			return nullptr;
+		}
+	};
+
+	// The free nodes of a pool cached by a thread: up to two magazines.
+	struct LocalCache {
+		std::shared_ptr<Core>                core;
+		std::array<Node *, 2 * MagazineSize> nodes;
+		size_t                               size = 0;
+		// Get() calls since the last trimming check.
+		size_t                               gets = 0;
+		// the trimEpoch of core when the cache was last synced.
+		uint64_t                             epoch;
+
+		inline explicit LocalCache(std::shared_ptr<Core> c)
+		    : core{std::move(c)}
+		    , epoch{core->trimEpoch.load(std::memory_order_relaxed)} {}
+
+		inline ~LocalCache() {
+			while (size > 0) {
+				flush(std::min(size, MagazineSize));
+			}
+		}
+
+		// Gives all the cached nodes back to the depot if the pool was
+		// trimmed since the last call, and trims them along with it.
+		inline void Sync() noexcept {
+			const auto current =
+			    core->trimEpoch.load(std::memory_order_relaxed);
+			if (current == epoch) {
+				return;
+			}
+			epoch = current;
+			while (size > 0) {
+				flush(std::min(size, MagazineSize));
+			}
+			core->TrimDepot();
+		}
+
+		inline void Refill() noexcept {
+			for (auto *node = core->Withdraw(); node != nullptr;
+			     node       = node->next) {
+				nodes[size++] = node;
+			}
+		}
+
+		// Gives count nodes back to the depot, or destroys them if it is
+		// full or the pool is destroyed.
+		inline void flush(size_t count) noexcept {
+			Node *chain = nullptr;
+			for (size_t i = 0; i < count; ++i) {
+				auto *node = nodes[--size];
+				node->next = chain;
+				chain      = node;
+			}
+			if (core->closing.load(std::memory_order_relaxed) == true) {
+				Core::Destroy(chain);
+			} else if (core->Deposit(chain) == false) {
+				core->Discard(chain);
+			}
+			core->Maintain();
+		}
+	};
+
+	using LocalCaches = std::vector<std::unique_ptr<LocalCache>>;
+
+	// Returns nullptr once the thread's caches are destroyed, as static
+	// objects may still use a pool after that.
+	inline static LocalCaches *localCaches() {
+		struct Holder {
+			LocalCaches caches;
+			bool       &destroyed;
+
+			inline ~Holder() {
+				caches.clear();
+				destroyed = true;
+			}
+		};
+
+		// trivially destructible, it remains valid after holder.
+		thread_local bool destroyed = false;
+		if (destroyed) {
+			return nullptr;
+		}
+		thread_local Holder holder{{}, destroyed};
+		return &holder.caches;
+	}
 
-		d_available.push_back(object);
-		d_condition.notify_one();
+	inline static LocalCache *localCache(Core &core) {
+		auto *caches = localCaches();
+		if (caches == nullptr) {
+			return nullptr;
+		}
+		for (auto &cache : *caches) {
+			if (cache->core.get() == &core) {
+				return cache.get();
+			}
+		}
+		// removes the caches of destroyed pools.
+		std::erase_if(*caches, [](const auto &cache) {
+			return cache->core->closing.load(std::memory_order_relaxed);
+		});
+		auto cache = std::make_unique<LocalCache>(core.shared_from_this());
+		return caches->emplace_back(std::move(cache)).get();
 	}
 
-	std::mutex d_mutex;
-	std::condition_variable d_condition;
+	inline static void release(Node *node) noexcept {
+		auto &core  = *node->core;
+		node->next  = nullptr;
+		node->bytes = BytesOf(*node->Object());
+		core.freeBytes.fetch_add(node->bytes, std::memory_order_relaxed);
+
+		// the cache, or keepAlive, keeps the core alive until the end of the
+		// call.
+		auto                 *cache = localCache(core);
+		std::shared_ptr<Core> keepAlive;
+		if (cache == nullptr) {
+			keepAlive = core.shared_from_this();
+		}
+
+		if (core.OverLimits()) {
+			core.Discard(node);
+		} else if (cache != nullptr) {
+			cache->Sync();
+			if (cache->size == cache->nodes.size()) {
+				cache->flush(MagazineSize);
+			}
+			cache->nodes[cache->size++] = node;
+		} else if (core.closing.load(std::memory_order_relaxed) == true) {
+			Core::Destroy(node);
+		} else if (core.Deposit(node) == false) {
+			core.Discard(node);
+		}
+		if (core.inUse.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+		    core.closing.load(std::memory_order_seq_cst) == true) {
+			core.inUse.notify_all();
+		}
+	}
 
-	std::vector<T *> d_objects;
-	std::vector<T *> d_available;
+	std::shared_ptr<Core> d_core;
 };
 
 } // namespace utils
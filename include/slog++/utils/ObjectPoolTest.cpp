@@ -4,6 +4,11 @@
 
 #include "ObjectPool.hpp"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace slog {
 namespace utils {
 
@@ -75,5 +80,182 @@ TEST(ObjectPool, Allocations) {
 	EXPECT_EQ(AllocationCounter<Object>::destructions, 2);
 }
 
+TEST(ObjectPool, PtrIsASinglePointer) {
+	static_assert(sizeof(ObjectPool<Buffer>::Ptr) == sizeof(Buffer *));
+}
+
+TEST(ObjectPool, ReusesReleasedObjects) {
+	ObjectPool<Buffer> pool;
+
+	Buffer *first = nullptr;
+	{
+		auto buffer = pool.Get();
+		first       = buffer.get();
+	}
+	EXPECT_EQ(pool.Get().get(), first);
+	EXPECT_EQ(pool.Capacity(), 1);
+}
+
+TEST(ObjectPool, ReleasedByOtherThreads) {
+	constexpr size_t count = 4 * ObjectPool<Buffer>::MagazineSize;
+
+	auto pool = std::make_unique<ObjectPool<Buffer>>();
+	pool->Reserve(count);
+	EXPECT_EQ(pool->Capacity(), count);
+
+	std::vector<ObjectPool<Buffer>::Ptr> buffers;
+	for (size_t i = 0; i < count; ++i) {
+		buffers.push_back(pool->Get());
+	}
+	EXPECT_EQ(pool->Capacity(), count);
+	EXPECT_EQ(pool->Available(), 0);
+
+	// the releasing thread flushes its magazines to the depot on exit.
+	std::thread releaser([&buffers]() { buffers.clear(); });
+	releaser.join();
+	EXPECT_EQ(pool->Available(), count);
+
+	for (size_t i = 0; i < count; ++i) {
+		buffers.push_back(pool->Get());
+	}
+	EXPECT_EQ(pool->Capacity(), count);
+	buffers.clear();
+	pool.reset();
+}
+
+TEST(ObjectPool, MaxObjects) {
+	ObjectPool<Buffer>::Limits limits;
+	limits.maxObjects = 2;
+	ObjectPool<Buffer> pool(limits);
+
+	std::vector<ObjectPool<Buffer>::Ptr> buffers;
+	for (size_t i = 0; i < 4; ++i) {
+		buffers.push_back(pool.Get());
+	}
+	EXPECT_EQ(pool.Capacity(), 4);
+	buffers.clear();
+	EXPECT_EQ(pool.Capacity(), 2);
+	EXPECT_EQ(pool.Available(), 2);
+	EXPECT_EQ(pool.Trimmed(), 2);
+}
+
+TEST(ObjectPool, MaxBytes) {
+	ObjectPool<Buffer>::Limits limits;
+	limits.maxBytes = 64 * 1024;
+	ObjectPool<Buffer> pool(limits);
+
+	{
+		auto small = pool.Get();
+		auto large = pool.Get();
+		small->reserve(1024);
+		large->reserve(1024 * 1024);
+		EXPECT_GE(ObjectPool<Buffer>::BytesOf(*large), 1024 * 1024);
+	}
+	EXPECT_EQ(pool.Capacity(), 1);
+	EXPECT_EQ(pool.Trimmed(), 1);
+	EXPECT_GE(pool.Get()->capacity(), 1024);
+}
+
+TEST(ObjectPool, TrimsAfterBurst) {
+	constexpr size_t burst = 16 * ObjectPool<Buffer>::MagazineSize;
+
+	ObjectPool<Buffer> pool;
+
+	std::vector<ObjectPool<Buffer>::Ptr> buffers;
+	for (size_t i = 0; i < burst; ++i) {
+		buffers.push_back(pool.Get());
+	}
+	buffers.clear();
+	EXPECT_EQ(pool.Capacity(), burst);
+	EXPECT_EQ(pool.Trimmed(), 0);
+
+	// including the magazines cached by this thread.
+	pool.Trim();
+	EXPECT_EQ(pool.Capacity(), 0);
+	EXPECT_EQ(pool.Trimmed(), burst);
+}
+
+TEST(ObjectPool, TrimsThreadCaches) {
+	constexpr size_t threads = 8;
+	constexpr size_t burst   = 2 * ObjectPool<Buffer>::MagazineSize;
+
+	ObjectPool<Buffer> pool;
+	std::mutex              mutex, serial;
+	std::condition_variable condition;
+	size_t                  step = 0, done = 0;
+	const auto              waitStep = [&](size_t s) {
+		std::unique_lock<std::mutex> lock(mutex);
+		++done;
+		condition.notify_all();
+		condition.wait(lock, [&]() { return step >= s; });
+	};
+	// runs check once all the threads reached step s, then releases them.
+	const auto nextStep = [&](size_t s, const auto &check) {
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&]() { return done == s * threads; });
+		check();
+		++step;
+		condition.notify_all();
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < threads; ++i) {
+		workers.emplace_back([&]() {
+			{
+				// released in the cache of the thread.
+				std::vector<ObjectPool<Buffer>::Ptr> buffers;
+				for (size_t j = 0; j < burst; ++j) {
+					buffers.push_back(pool.Get());
+				}
+			}
+			waitStep(1);
+			{
+				// the next use gives the cached objects back after a
+				// trimming. Concurrent uses could take them back.
+				std::scoped_lock<std::mutex> lock(serial);
+				pool.Get();
+			}
+			waitStep(2);
+		});
+	}
+
+	nextStep(1, [&]() {
+		EXPECT_EQ(pool.Capacity(), threads * burst);
+		pool.Trim();
+		EXPECT_EQ(pool.Capacity(), threads * burst);
+	});
+	nextStep(2, [&]() {
+		// the threads are still alive, and only cache their last object.
+		EXPECT_EQ(pool.Capacity(), threads);
+	});
+	for (auto &worker : workers) {
+		worker.join();
+	}
+}
+
+TEST(ObjectPool, TrimsPeriodically) {
+	constexpr size_t burst = 16 * ObjectPool<Buffer>::MagazineSize;
+
+	ObjectPool<Buffer>::Limits limits;
+	limits.trimPeriod = std::chrono::milliseconds(1);
+	ObjectPool<Buffer> pool(limits);
+	{
+		std::vector<ObjectPool<Buffer>::Ptr> buffers;
+		for (size_t i = 0; i < burst; ++i) {
+			buffers.push_back(pool.Get());
+		}
+	}
+
+	// steady state usage, with one object at a time.
+	for (size_t i = 0; i < 8 && pool.Trimmed() == 0; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		for (size_t j = 0; j < ObjectPool<Buffer>::CheckInterval; ++j) {
+			pool.Get();
+		}
+	}
+	EXPECT_GT(pool.Trimmed(), 0);
+	EXPECT_LT(pool.Capacity(), burst);
+}
+
 } // namespace utils
 } // namespace slog
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "RingBuffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace slog {
+namespace utils {
+
+// A multi-producer single-consumer queue made of one single-producer
+// RingBuffer per producing thread. Producers lazily register their own lane on
+// their first push, and afterwards never share any cache line with other
+// producers. The consumer merges the lanes: TryPop() returns the smallest
+// element, according to Less, among the fronts of all lanes. Elements are
+// therefore ordered within what has been made visible to the consumer, not
+// across elements pushed later in another lane.
+template <typename T, typename Less = std::less<T>> class PerThreadQueue {
+public:
+	inline PerThreadQueue(size_t laneCapacity, Less less = Less{})
+	    : d_laneCapacity{laneCapacity}
+	    , d_less{std::move(less)}
+	    , d_ID{nextID()} {}
+
+	// PerThreadQueue is non-movable non-copyable
+	PerThreadQueue(const PerThreadQueue &)            = delete;
+	PerThreadQueue(PerThreadQueue &&)                 = delete;
+	PerThreadQueue &operator=(const PerThreadQueue &) = delete;
+	PerThreadQueue &operator=(PerThreadQueue &&)      = delete;
+
+	// Pushes value in the calling thread's lane. value is only moved from if
+	// the operation succeeds. Returns false if the lane is full.
+	inline bool TryPush(T &value) {
+		return localLane().ring.TryPush(value);
+	}
+
+	// Pops the oldest element of the calling thread's lane. Unlike TryPop(),
+	// it is safe to call concurrently with the consumer.
+	inline bool TryEvict(T &value) {
+		return localLane().ring.TryPop(value);
+	}
+
+	// Pops the smallest front element of all lanes. Must only be called by a
+	// single consumer at a time.
+	inline bool TryPop(T &value) {
+		refreshLanes();
+
+		Consumed *best = nullptr;
+		for (auto &c : d_consumed) {
+			if (c.staged.has_value() == false) {
+				T front;
+				if (c.lane->ring.TryPop(front) == false) {
+					continue;
+				}
+				c.staged = std::move(front);
+			}
+			if (best == nullptr || d_less(*c.staged, *best->staged)) {
+				best = &c;
+			}
+		}
+
+		if (best == nullptr) {
+			return false;
+		}
+		value = std::move(*best->staged);
+		best->staged.reset();
+		return true;
+	}
+
+	// Returns true if no element is ready to be popped. Must only be called
+	// by the consumer.
+	inline bool Empty() {
+		refreshLanes();
+		for (const auto &c : d_consumed) {
+			if (c.staged.has_value() || c.lane->ring.Empty() == false) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline size_t LaneCapacity() const noexcept {
+		return d_laneCapacity;
+	}
+
+private:
+	struct Lane {
+		inline Lane(size_t capacity)
+		    : ring{capacity} {}
+
+		RingBuffer<T, true> ring;
+		// set when the producing thread exits.
+		std::atomic<bool> closed{false};
+	};
+
+	using LanePtr = std::shared_ptr<Lane>;
+
+	struct Consumed {
+		LanePtr          lane;
+		std::optional<T> staged;
+	};
+
+	// The lanes a thread produces into, keyed by queue ID. IDs are never
+	// reused, so entries of destroyed queues can never be matched again.
+	struct LocalLanes {
+		std::vector<std::pair<uint64_t, LanePtr>> lanes;
+
+		inline ~LocalLanes() {
+			for (auto &[id, lane] : lanes) {
+				lane->closed.store(true, std::memory_order_release);
+			}
+		}
+	};
+
+	inline static uint64_t nextID() {
+		static std::atomic<uint64_t> id{0};
+		return id.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	inline Lane &localLane() {
+		thread_local LocalLanes local;
+		for (auto &[id, lane] : local.lanes) {
+			if (id == d_ID) {
+				return *lane;
+			}
+		}
+
+		auto lane = std::make_shared<Lane>(d_laneCapacity);
+		{
+			std::scoped_lock<std::mutex> lock(d_mutex);
+			d_lanes.push_back(lane);
+			d_version.fetch_add(1, std::memory_order_release);
+		}
+		// removes entries of destroyed queues, as they will never be used
+		// again.
+		std::erase_if(local.lanes, [](const auto &entry) {
+			return entry.second.use_count() == 1;
+		});
+		local.lanes.push_back({d_ID, lane});
+		return *lane;
+	}
+
+	// A lane is done when its producer exited and it is fully consumed. It
+	// cannot be refilled anymore.
+	inline static bool isDone(const Consumed &c) noexcept {
+		return c.staged.has_value() == false &&
+		       c.lane->closed.load(std::memory_order_acquire) &&
+		       c.lane->ring.Empty();
+	}
+
+	inline void refreshLanes() {
+		auto version = d_version.load(std::memory_order_acquire);
+		if (version == d_consumedVersion &&
+		    std::none_of(d_consumed.begin(), d_consumed.end(), isDone)) {
+			return;
+		}
+
+		std::scoped_lock<std::mutex> lock(d_mutex);
+		// adds newly registered lanes.
+		for (const auto &lane : d_lanes) {
+			if (std::none_of(
+			        d_consumed.begin(),
+			        d_consumed.end(),
+			        [&lane](const Consumed &c) { return c.lane == lane; }
+			    )) {
+				d_consumed.push_back({lane, std::nullopt});
+			}
+		}
+		std::erase_if(d_consumed, isDone);
+		std::erase_if(d_lanes, [this](const LanePtr &lane) {
+			return std::none_of(
+			    d_consumed.begin(),
+			    d_consumed.end(),
+			    [&lane](const Consumed &c) { return c.lane == lane; }
+			);
+		});
+		d_consumedVersion = version;
+	}
+
+	const size_t   d_laneCapacity;
+	Less           d_less;
+	const uint64_t d_ID;
+
+	// producers registration, protected by d_mutex.
+	std::mutex            d_mutex;
+	std::vector<LanePtr>  d_lanes;
+	std::atomic<uint64_t> d_version{0};
+
+	// consumer only state.
+	std::vector<Consumed> d_consumed;
+	uint64_t              d_consumedVersion = 0;
+};
+
+} // namespace utils
+} // namespace slog
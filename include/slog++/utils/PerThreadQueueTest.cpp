@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "PerThreadQueue.hpp"
+
+namespace slog {
+namespace utils {
+
+TEST(PerThreadQueue, SingleThreadIsFIFO) {
+	PerThreadQueue<int> queue(4);
+	EXPECT_TRUE(queue.Empty());
+
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_TRUE(queue.TryPush(i));
+	}
+	int value = 42;
+	EXPECT_FALSE(queue.TryPush(value));
+	EXPECT_EQ(value, 42);
+
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_TRUE(queue.TryPop(value));
+		EXPECT_EQ(value, i);
+	}
+	EXPECT_FALSE(queue.TryPop(value));
+	EXPECT_TRUE(queue.Empty());
+}
+
+TEST(PerThreadQueue, MergesLanes) {
+	PerThreadQueue<int> queue(8);
+
+	auto pushAll = [&queue](std::vector<int> values) {
+		std::thread([&queue, &values]() {
+			for (auto &v : values) {
+				EXPECT_TRUE(queue.TryPush(v));
+			}
+		}).join();
+	};
+	pushAll({1, 4, 5, 8});
+	pushAll({0, 2, 3, 9});
+	pushAll({6, 7});
+
+	for (int expected = 0; expected < 10; ++expected) {
+		int value;
+		ASSERT_TRUE(queue.TryPop(value));
+		EXPECT_EQ(value, expected);
+	}
+	EXPECT_TRUE(queue.Empty());
+}
+
+TEST(PerThreadQueue, ConcurrentProducers) {
+	constexpr static int Producers = 4;
+	constexpr static int Count     = 10000;
+
+	PerThreadQueue<int> queue(64);
+
+	std::vector<std::thread> producers;
+	for (int p = 0; p < Producers; ++p) {
+		producers.emplace_back([&queue, p]() {
+			for (int i = 0; i < Count; ++i) {
+				int value = p * Count + i;
+				while (queue.TryPush(value) == false) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::vector<int> last(Producers, -1);
+	for (int received = 0; received < Producers * Count;) {
+		int value;
+		if (queue.TryPop(value) == false) {
+			std::this_thread::yield();
+			continue;
+		}
+		++received;
+		int producer = value / Count;
+		EXPECT_GT(value % Count, last[producer]);
+		last[producer] = value % Count;
+	}
+
+	for (auto &t : producers) {
+		t.join();
+	}
+	EXPECT_TRUE(queue.Empty());
+}
+
+} // namespace utils
+} // namespace slog
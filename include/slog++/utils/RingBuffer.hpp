@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace slog {
+namespace utils {
+
+// We do not use std::hardware_destructive_interference_size as its value is
+// not ABI stable, and compilers warn about its usage in headers.
+constexpr size_t CacheLineSize = 64;
+
+// A bounded lock-free queue, based on D. Vyukov's bounded MPMC queue. Each slot
+// carries a sequence number that tells producers and consumers if it is ready
+// to be written or read. Producers only contend on the tail, the consumer only
+// on the head, and both are kept on their own cache line. The capacity is
+// rounded up to the next power of two, and all memory is allocated once at
+// construction: pushing or popping never allocates nor makes any syscall.
+//
+// When SingleProducer is set, only one thread at a time may push, and the tail
+// is updated without any read-modify-write operation.
+template <
+    typename T,
+    bool SingleProducer = false,
+    std::enable_if_t<std::is_nothrow_move_constructible_v<T>> * = nullptr>
+class RingBuffer {
+public:
+	inline RingBuffer(size_t capacity)
+	    : d_mask{std::bit_ceil(std::max(capacity, size_t(2))) - 1}
+	    , d_slots{new Slot[d_mask + 1]} {
+		for (size_t i = 0; i <= d_mask; ++i) {
+			d_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	inline ~RingBuffer() {
+		auto head = d_head.load(std::memory_order_acquire);
+		auto tail = d_tail.load(std::memory_order_acquire);
+		for (; head != tail; ++head) {
+			std::launder(reinterpret_cast<T *>(d_slots[head & d_mask].storage))
+			    ->~T();
+		}
+	}
+
+	// RingBuffer is non-movable non-copyable
+	RingBuffer(const RingBuffer &)            = delete;
+	RingBuffer(RingBuffer &&)                 = delete;
+	RingBuffer &operator=(const RingBuffer &) = delete;
+	RingBuffer &operator=(RingBuffer &&)      = delete;
+
+	// Pushes value at the end of the queue. value is only moved from if the
+	// operation succeeds. Returns false if the queue is full.
+	inline bool TryPush(T &value) noexcept {
+		size_t pos = d_tail.load(std::memory_order_relaxed);
+		Slot  *slot;
+		if constexpr (SingleProducer) {
+			slot     = &d_slots[pos & d_mask];
+			auto seq = slot->sequence.load(std::memory_order_acquire);
+			if (seq != pos) {
+				return false;
+			}
+			d_tail.store(pos + 1, std::memory_order_relaxed);
+		}
+		while (!SingleProducer) {
+			slot     = &d_slots[pos & d_mask];
+			auto seq = slot->sequence.load(std::memory_order_acquire);
+			auto dif = intptr_t(seq) - intptr_t(pos);
+			if (dif == 0) {
+				if (d_tail.compare_exchange_weak(
+				        pos,
+				        pos + 1,
+				        std::memory_order_relaxed
+				    )) {
+					break;
+				}
+			} else if (dif < 0) {
+				return false;
+			} else {
+				pos = d_tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		new (slot->storage) T(std::move(value));
+		slot->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Pops the front of the queue into value. Returns false if the queue is
+	// empty.
+	inline bool TryPop(T &value) noexcept {
+		size_t pos = d_head.load(std::memory_order_relaxed);
+		Slot  *slot;
+		while (true) {
+			slot     = &d_slots[pos & d_mask];
+			auto seq = slot->sequence.load(std::memory_order_acquire);
+			auto dif = intptr_t(seq) - intptr_t(pos + 1);
+			if (dif == 0) {
+				if (d_head.compare_exchange_weak(
+				        pos,
+				        pos + 1,
+				        std::memory_order_relaxed
+				    )) {
+					break;
+				}
+			} else if (dif < 0) {
+				return false;
+			} else {
+				pos = d_head.load(std::memory_order_relaxed);
+			}
+		}
+
+		auto *stored = std::launder(reinterpret_cast<T *>(slot->storage));
+		value        = std::move(*stored);
+		stored->~T();
+		slot->sequence.store(pos + d_mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Returns true if there is no element ready to be popped. It is only a
+	// snapshot of the queue state, which may change concurrently.
+	inline bool Empty() const noexcept {
+		size_t pos  = d_head.load(std::memory_order_acquire);
+		auto  &slot = d_slots[pos & d_mask];
+		auto   seq  = slot.sequence.load(std::memory_order_acquire);
+		return intptr_t(seq) - intptr_t(pos + 1) < 0;
+	}
+
+	inline size_t Capacity() const noexcept {
+		return d_mask + 1;
+	}
+
+private:
+	struct Slot {
+		std::atomic<size_t>          sequence;
+		alignas(T) std::byte storage[sizeof(T)];
+	};
+
+	const size_t            d_mask;
+	std::unique_ptr<Slot[]> d_slots;
+
+	alignas(CacheLineSize) std::atomic<size_t> d_head{0};
+	// the alignment of d_tail also pads the object to a full cache line, so
+	// nothing else shares it.
+	alignas(CacheLineSize) std::atomic<size_t> d_tail{0};
+};
+
+} // namespace utils
+} // namespace slog
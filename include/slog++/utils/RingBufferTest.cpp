@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "RingBuffer.hpp"
+
+namespace slog {
+namespace utils {
+
+TEST(RingBuffer, CapacityIsPowerOfTwo) {
+	EXPECT_EQ(RingBuffer<int>(0).Capacity(), 2);
+	EXPECT_EQ(RingBuffer<int>(3).Capacity(), 4);
+	EXPECT_EQ(RingBuffer<int>(64).Capacity(), 64);
+	EXPECT_EQ(RingBuffer<int>(65).Capacity(), 128);
+}
+
+TEST(RingBuffer, FIFO) {
+	RingBuffer<int> queue(4);
+	EXPECT_TRUE(queue.Empty());
+
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_TRUE(queue.TryPush(i));
+	}
+	int value = 42;
+	EXPECT_FALSE(queue.TryPush(value));
+	EXPECT_EQ(value, 42);
+	EXPECT_FALSE(queue.Empty());
+
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_TRUE(queue.TryPop(value));
+		EXPECT_EQ(value, i);
+	}
+	EXPECT_FALSE(queue.TryPop(value));
+	EXPECT_TRUE(queue.Empty());
+}
+
+TEST(RingBuffer, DestroysRemainingElements) {
+	auto counter = std::make_shared<int>(0);
+	{
+		RingBuffer<std::shared_ptr<int>> queue(4);
+		for (int i = 0; i < 3; ++i) {
+			auto copy = counter;
+			EXPECT_TRUE(queue.TryPush(copy));
+			EXPECT_EQ(copy, nullptr);
+		}
+		std::shared_ptr<int> popped;
+		EXPECT_TRUE(queue.TryPop(popped));
+		EXPECT_EQ(counter.use_count(), 4);
+	}
+	EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(RingBuffer, MultipleProducers) {
+	constexpr static int Producers = 4;
+	constexpr static int Count     = 10000;
+
+	RingBuffer<int> queue(64);
+
+	std::vector<std::thread> producers;
+	for (int p = 0; p < Producers; ++p) {
+		producers.emplace_back([&queue, p]() {
+			for (int i = 0; i < Count; ++i) {
+				int value = p * Count + i;
+				while (queue.TryPush(value) == false) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::vector<int> last(Producers, -1);
+	for (int received = 0; received < Producers * Count;) {
+		int value;
+		if (queue.TryPop(value) == false) {
+			std::this_thread::yield();
+			continue;
+		}
+		++received;
+		// each producer's values must be received in order.
+		int producer = value / Count;
+		EXPECT_GT(value % Count, last[producer]);
+		last[producer] = value % Count;
+	}
+
+	for (auto &t : producers) {
+		t.join();
+	}
+	EXPECT_TRUE(queue.Empty());
+}
+
+} // namespace utils
+} // namespace slog
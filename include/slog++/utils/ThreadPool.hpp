@@ -2,22 +2,35 @@
 
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace slog {
 namespace utils {
 
+// A pool of worker threads processing queued jobs in FIFO order. The workers
+// share their state with the pool, so a job may destroy the pool it runs on:
+// its own worker is then detached and exits once the job returns. When the
+// pool is resized to zero, the pending jobs are processed before its workers
+// exit.
 class ThreadPool {
 public:
 	~ThreadPool() {
 		this->SetSize(0);
 	}
 
-	ThreadPool() = default;
+	ThreadPool()
+	    : d_state{std::make_shared<State>()} {}
 
 	ThreadPool(const ThreadPool &)            = delete;
 	ThreadPool(ThreadPool &&)                 = delete;
@@ -29,78 +42,136 @@ public:
 	template <typename Function, typename... Args>
 	void Queue(Function &&f, Args &&...args) {
 		{
-			std::scoped_lock<std::mutex> lock(d_mutex);
+			std::unique_lock<std::mutex> lock(d_state->mutex);
 
-			if (d_threads.empty()) {
+			if (d_state->wantedSize == 0) {
+				lock.unlock();
 				std::forward<Function>(f)(std::forward<Args>(args)...);
 				return;
 			}
 
-			auto job =
-			    [f, args = std::tuple(std::forward<Args>(args)...)]() mutable {
+			d_state->queue.emplace(
+			    [f = std::forward<Function>(f),
+			     args = std::tuple(std::forward<Args>(args)...)]() mutable {
 				    std::apply(
-				        [f](auto &&...args) { f(std::forward<Args>(args)...); },
+				        [&f](auto &&...args) {
+					        f(std::forward<decltype(args)>(args)...);
+				        },
 				        std::move(args)
 				    );
-			    };
+			    }
+			);
 		}
-		d_conditions.notify_one();
+		d_state->conditions.notify_one();
+	}
+
+	inline size_t Size() {
+		std::scoped_lock<std::mutex> lock(d_state->mutex);
+		return d_state->wantedSize;
 	}
 
 	inline void SetSize(size_t size) {
 
 		{
-			std::scoped_lock<std::mutex> lock(d_mutex);
-			d_wantedSize = size;
+			std::scoped_lock<std::mutex> lock(d_state->mutex);
+			d_state->wantedSize = size;
 		}
 
 		while (size < d_threads.size()) {
-			d_conditions.notify_all();
-			d_threads.back().join();
+			d_state->conditions.notify_all();
+			if (d_threads.back().get_id() == std::this_thread::get_id()) {
+				d_threads.back().detach();
+			} else {
+				d_threads.back().join();
+			}
 			d_threads.pop_back();
 		}
 
 		while (size > d_threads.size()) {
-			int privateID = d_threads.size();
-			d_threads.emplace_back([this, privateID] {
-				this->waitAndProcess(privateID);
+			size_t privateID = d_threads.size();
+			d_threads.emplace_back([state = d_state, privateID] {
+				state->waitAndProcess(privateID);
 			});
 		}
 	}
 
-private:
-	inline bool shouldQuit(int privateID) const noexcept {
-		return privateID >= d_wantedSize;
+	// Returns true if cpu can be given to SetAffinity() on this platform.
+	inline static bool ValidCPU(size_t cpu) noexcept {
+#ifdef __linux__
+		return cpu < CPU_SETSIZE;
+#else
+		return false;
+#endif
 	}
 
-	inline bool hasJob() const noexcept {
-		return !d_queue.empty();
+	// Restricts the current workers to the given CPUs. Returns false if it is
+	// not supported on this platform, if any of the CPUs is not valid, or if
+	// any of the workers could not be pinned.
+	inline bool SetAffinity(const std::vector<size_t> &cpus) {
+#ifdef __linux__
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (auto cpu : cpus) {
+			if (!ValidCPU(cpu)) {
+				return false;
+			}
+			CPU_SET(cpu, &set);
+		}
+		bool res = true;
+		for (auto &t : d_threads) {
+			auto handle = t.native_handle();
+			if (pthread_setaffinity_np(handle, sizeof(set), &set) != 0) {
+				res = false;
+			}
+		}
+		return res;
+#else
+		return false;
+#endif
 	}
 
-	inline void waitAndProcess(int privateID) {
-		std::unique_lock<std::mutex> lock(d_mutex);
-
-		d_conditions.wait(lock, [this, privateID] {
-			return shouldQuit(privateID) || hasJob();
-		});
+private:
+	struct State {
+		std::mutex              mutex;
+		std::condition_variable conditions;
+		size_t                  wantedSize = 0;
+		std::queue<Job>         queue;
+
+		inline bool shouldQuit(size_t privateID) const noexcept {
+			return privateID >= wantedSize;
+		}
 
-		if (shouldQuit(privateID)) {
-			return;
+		inline bool hasJob() const noexcept {
+			return !queue.empty();
 		}
 
-		auto &job = d_queue.front();
-		job();
-		d_queue.pop();
-	}
+		inline void waitAndProcess(size_t privateID) {
+			std::unique_lock<std::mutex> lock(mutex);
 
-	std::mutex              d_mutex;
-	std::condition_variable d_conditions;
+			while (true) {
+				conditions.wait(lock, [this, privateID] {
+					return shouldQuit(privateID) || hasJob();
+				});
 
-	std::vector<std::thread> d_threads;
+				if (shouldQuit(privateID) &&
+				    (wantedSize > 0 || hasJob() == false)) {
+					return;
+				}
 
-	size_t d_wantedSize = 0;
+				auto job = std::move(queue.front());
+				queue.pop();
 
-	std::queue<Job> d_queue;
+				lock.unlock();
+				job();
+				// the job may own the pool, it must be released unlocked.
+				job = nullptr;
+				lock.lock();
+			}
+		}
+	};
+
+	std::shared_ptr<State>   d_state;
+	std::vector<std::thread> d_threads;
 };
 
 } // namespace utils
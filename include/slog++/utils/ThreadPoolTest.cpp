@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace slog {
+namespace utils {
+
+TEST(ThreadPool, RunsInlineWithoutWorkers) {
+	ThreadPool pool;
+	std::thread::id id;
+	pool.Queue([&id]() { id = std::this_thread::get_id(); });
+	EXPECT_EQ(id, std::this_thread::get_id());
+}
+
+TEST(ThreadPool, SingleWorkerIsFIFO) {
+	ThreadPool pool;
+	pool.SetSize(1);
+
+	std::vector<int>   values;
+	std::promise<void> done;
+	for (int i = 0; i < 100; ++i) {
+		pool.Queue([&values](int i) { values.push_back(i); }, i);
+	}
+	pool.Queue([&done]() { done.set_value(); });
+	done.get_future().wait();
+
+	ASSERT_EQ(values.size(), 100);
+	for (int i = 0; i < 100; ++i) {
+		EXPECT_EQ(values[i], i);
+	}
+}
+
+TEST(ThreadPool, ProcessesPendingJobsBeforeStopping) {
+	ThreadPool pool;
+	pool.SetSize(1);
+
+	std::promise<void> started, resume;
+	int                count = 0;
+	pool.Queue([&]() {
+		started.set_value();
+		resume.get_future().wait();
+	});
+	for (int i = 0; i < 10; ++i) {
+		pool.Queue([&count]() { ++count; });
+	}
+	started.get_future().wait();
+	resume.set_value();
+	pool.SetSize(0);
+	EXPECT_EQ(count, 10);
+}
+
+TEST(ThreadPool, JobsCanDestroyTheirPool) {
+	auto pool = std::make_shared<ThreadPool>();
+	pool->SetSize(1);
+
+	std::promise<void> released, done;
+	pool->Queue([pool, &released, &done]() mutable {
+		released.get_future().wait();
+		// the last reference is released by the pool's own worker.
+		pool.reset();
+		done.set_value();
+	});
+	pool.reset();
+	released.set_value();
+	done.get_future().wait();
+}
+
+} // namespace utils
+} // namespace slog